@@ -7,8 +7,10 @@
  */
 
 #include "Activity.h"
+#include "schema.h"
 #include "User.h"
 #include "list.h"
+#include "hash.h"
 #include <string.h>
 #include <assert.h>
 #include <stdio.h>
@@ -21,7 +23,6 @@
 #define NR_HOURS 14 /**< Nr of working hours */
 
 #define STR_SZ 30 /**< Buffer size for sprintf */
-#define ACT_FIFO_SZ 1024 /**< FIFO's size is unknown; define a sufficiently larger one */
 
 
 /**
@@ -44,6 +45,7 @@ struct Act_T // Atomic
     unsigned vagas; /**< nr of vacancies */
     unsigned max_vagas; /**< Nr of max vacancies */
     List_T users; /**< List of users enlisted to the activity */
+    bool borrowed; /**< true, if nome is borrowed from a load buffer */
 };
 
 /**
@@ -155,11 +157,27 @@ static int activity_get_mins(const Act_T activity)
     return (activity->mins_from_start % 60);
 }
 
+/**
+ * @brief Makes the Activity own its name
+ * @param activity: a constructed activity
+ *
+ * Activities loaded from the database borrow their name from the load 
+ * buffer (@see activity_deserialize); it is copied before being modified.
+ */
+static void activity_own(Act_T activity)
+{
+    if(!activity->borrowed)
+        return;
+    activity->nome = str_dup(activity->nome);
+    activity->borrowed = false;
+}
+
 Act_T activity_ctor()
 {
    Act_T activity = activity_new();
    /* Construct Activity */
    activity->nome = NULL;
+   activity->borrowed = false;
    activity->mins_from_start = 0;
    activity->duracao = 15; // mins
    activity->custo = 5.0; // EURO
@@ -180,7 +198,8 @@ void activity_dtor(Act_T activity)
         return;
 
     /* Release dynamically allocated memory first */
-    free(activity->nome);
+    if(!activity->borrowed)
+        free(activity->nome);
 
     /* Release activity */
     free(activity);
@@ -192,10 +211,11 @@ bool activity_clone(const Act_T activity, Act_T clone)
         return false;
 
    /* Copy info to clone from activity */
+   activity_own(clone);
    if(activity->nome)
    {
-       clone->nome = malloc(strlen(activity->nome) + 1);
-       strcpy(clone->nome, activity->nome);
+       free(clone->nome);
+       clone->nome = str_dup(activity->nome);
    }
    clone->mins_from_start = activity->mins_from_start;
    clone->duracao = activity->duracao;
@@ -274,6 +294,7 @@ int activity_set_nome(Act_T activity)
             return B_FALSE; // invalid
     } while (!validateString(input));
 
+    activity_own(activity); // modifying: stop borrowing
 
     // allocate dinamic memory for string
     if( !activity->nome )
@@ -458,6 +479,11 @@ int activity_cmp_name(const Act_T activity1, const Act_T activity2)
     return strcmp(activity1->nome, activity2->nome);
 }
 
+unsigned activity_hash_name(const Act_T activity)
+{
+    return Hash_string(activity->nome);
+}
+
 /* List related */
 bool activity_add_user(Act_T activity, const User_T user)
 {
@@ -497,75 +523,56 @@ bool activity_remove_user(Act_T activity, const User_T user)
     return true;
 }
 
+/**
+ * @brief Serialized fields of the activity, in order (@see schema.h)
+ *
+ * The users are relations to other objects, not attributes: they are not
+ * serialized.
+ */
+#define ACTIVITY_SCHEMA(X)     \
+    X(STR, nome)               \
+    X(INT, mins_from_start)    \
+    X(INT, duracao)            \
+    X(REAL, custo)             \
+    X(UINT, vagas)             \
+    X(UINT, max_vagas)
+
+SCHEMA_DEFINE(activity, Act_T, ACTIVITY_SCHEMA)
+
 Fifo_T activity_serialize(Act_T activity)
 {
     if(!activity)
         return NULL;
 
-//    char *nome; // rw
-//    long mins_from_start; // rw (time from start of the week)
-//    int duracao; // rw (mins)
-//    float custo; // rw (euro)
-//    unsigned vagas; // rw
-//    unsigned max_vagas; // rw
-//    List_T users; // rw
-
-/* Unknown size -> fix a sufficiently large buffer */
-    size_t sz = ACT_FIFO_SZ;
- 
-    Fifo_T fifo = Fifo_ctor(sz);
-    //Fifo_push(fifo, &sz, sizeof(sz));
-
-/* Nome */
-    sz = strlen(activity->nome) + 1;
-    Fifo_push(fifo, &sz, sizeof(sz));
-    Fifo_push(fifo, activity->nome, sz);
-/* mins_from_start */
-    Fifo_push(fifo, &(activity->mins_from_start), 
-              sizeof(activity->mins_from_start));
-/* duracao */
-    Fifo_push(fifo, &(activity->duracao), sizeof(activity->duracao));
-/* custo */
-    Fifo_push(fifo, &(activity->custo), sizeof(activity->custo));
-/* vagas */
-    Fifo_push(fifo, &(activity->vagas), sizeof(activity->vagas));
-/* max_vagas */
-    Fifo_push(fifo, &(activity->max_vagas), sizeof(activity->max_vagas));
-/* users (List_T) */
-
-
-/* Reset size to actual size (write position) */
-    Fifo_set_size(fifo, Fifo_get_write_idx(fifo));
-
+    Fifo_T fifo = Fifo_ctor(activity_schema_size(activity));
+    activity_schema_encode(activity, fifo);
     return fifo;
 }
 
+size_t activity_serialize_into(const Act_T activity, Fifo_T fifo)
+{
+    if(!activity || !fifo)
+        return 0;
+
+    activity_schema_encode(activity, fifo);
+    return Fifo_get_write_idx(fifo);
+}
+
 Act_T activity_deserialize(Fifo_T fifo)
 {
     if(!fifo)
         return NULL;
-    size_t sz = 0;
 
     /* Construct a activity */
     Act_T activity = activity_ctor();
-/* Retrieve size of nome */
-    Fifo_pop(fifo, &sz, sizeof(sz));
-/* Initialize nome */
-    activity->nome = malloc(sz);
-    assert(activity->nome);
-    Fifo_pop(fifo, activity->nome, sz);
-/* mins_from_start */
-    Fifo_pop(fifo, &(activity->mins_from_start), 
-              sizeof(activity->mins_from_start));
-/* Initialize duracao */
-    Fifo_pop(fifo, &(activity->duracao), sizeof(activity->duracao));
-/* Initialize custo */
-    Fifo_pop(fifo, &(activity->custo), sizeof(activity->custo));
-/* vagas */
-    Fifo_pop(fifo, &(activity->vagas), sizeof(activity->vagas));
-/* max_vagas */
-    Fifo_pop(fifo, &(activity->max_vagas), sizeof(activity->max_vagas));
-/* users (List_T) */
+
+/* Decode the fields; nome is borrowed from the buffer (no copy) */
+    activity->borrowed = true;
+    if( !activity_schema_decode(activity, fifo) )
+    {
+        activity_dtor(activity);
+        return NULL;
+    }
 
     return activity;
 }
@@ -213,6 +213,16 @@ int activity_cmp_time(const Act_T activity1,const Act_T activity2);
  * perform sorted insertion and sorting.
  */
 int activity_cmp_name(const Act_T activity1,const Act_T activity2);
+
+/**
+ * @brief Hashes an activity by name
+ * @param activity: a constructed activity
+ * @return hash value of the *name* attribute
+ *
+ * Case sensitive, consistent with activity_cmp_name.
+ * @see hash.h: *Hash* functions are required by *Hash* to index activities.
+ */
+unsigned activity_hash_name(const Act_T activity);
 /* ------------------------------------------------------------------- */
 
 /*-------------------------- List related ---------------------------- */
@@ -254,6 +264,26 @@ bool activity_remove_user(Act_T activity, const User_T user);
  */
 Fifo_T activity_serialize(Act_T activity);
 
+/**
+ * @brief Serializes activity attributes, appending them to a FIFO
+ * @param activity: a constructed activity
+ * @param fifo: a valid FIFO; it grows as needed
+ * @return the FIFO's write index after the activity; 0 in error
+ *
+ * Lets the caller reuse one FIFO for many records (@see Fifo_reset).
+ * @see fifo.h
+ */
+size_t activity_serialize_into(const Act_T activity, Fifo_T fifo);
+
+/**
+ * @brief Prints every serialized field of the activity, one per line
+ * @param activity: a constructed activity
+ *
+ * Used for debugging; generated from the activity's schema.
+ * @see schema.h
+ */
+void activity_print_fields(const Act_T activity);
+
 /**
  * @brief Deserializes activity attributes into a FIFO
  * @param fifo: FIFO buffer containing the serialized activity
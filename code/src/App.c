@@ -9,14 +9,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <ctype.h>
+#include <string.h>
 #include <strings.h>
 #include "App.h"
 #include "list.h"
+#include "vec.h"
 #include "User.h"
 #include "Activity.h"
 #include "Menu.h"
 #include "Pack.h"
 #include "Database.h"
+#include "btree.h"
 #include "m-utils.h"
 
 #define DEBUG /**< For debugging throughout the code */
@@ -37,8 +41,13 @@
 
 /* Database files */
 #define DATABASE_USERS "user.db" /**< Database file for users */
+#define DATABASE_USERS_INDEX "user.idx" /**< Index of users by username */
 #define DATABASE_ACTIVITIES "act.db" /**< Database file for activities */  
 #define DATABASE_PACKS "pack.db" /**< Database file for packs */
+#define DATABASE_WBUF_SZ (4 << 20) /**< Writer buffer of a save (bytes) */
+#define DATABASE_JOURNAL "journal.db" /**< Journal of the changes */
+#define JOURNAL_CHECKPOINT 256 /**< Journal records between checkpoints */
+#define INDEX_LOC_JOURNAL (1ULL << 63) /**< Index locator in the journal */
 
 
 /**
@@ -60,6 +69,23 @@ enum App_state{
     S_Quit/**< Quit state */
 };
 
+/**
+ * @brief Operations of the journal
+ */
+enum App_journal_op{
+    J_Put, /**< Add or update a record (by its key) */
+    J_Del /**< Remove a record (by its key) */
+};
+
+/**
+ * @brief Kinds of records of the journal, i.e., the databases they belong to
+ */
+enum App_journal_kind{
+    J_User, /**< User record (key: username) */
+    J_Act, /**< Activity record (key: start time) */
+    J_Pack /**< Pack record (key: name) */
+};
+
 /**
  * @brief App's struct: contains the relevant data members
  */
@@ -68,14 +94,20 @@ struct App_T
     List_T menus; /**< Menus list */
     List_T users;  /**< Users list */
     List_T activities; /**< Activities list */
-    List_T packs; /**< List of available packs */
+    Vec_T packs; /**< Sorted array of available packs */
     User_T cur_user; /**< Current user */
     enum App_state state; /**< App's current state */
     enum App_state prev_state; /**< App's previous state */
     void * userdata; /**< ptr to generic data (used in App_state_functions) */
     Database_T db_user; /**< Users database */
+    BTree_T user_index; /**< Users' records in db_user, by username */
     Database_T db_act; /**< Activities database */
     Database_T db_pack; /**< Packs database */
+    Database_T db_journal; /**< Journal of the changes since the checkpoint */
+    Fifo_T journal_buf; /**< scratch buffer of the journal's records */
+    unsigned journal_ops; /**< nr. of records in the journal */
+    bool journal_unsynced; /**< the journal has records not yet durable */
+    bool journal_failed; /**< a change was not journaled since the commit */
 };
 
 /**
@@ -98,6 +130,10 @@ static App_T App_new()
  * @param deserialize: pointer to generic function capable of deserializing the specific data of the database
  * @return packet of data; NULL if failure occured
  *
+ * The database is read once into a buffer (@see Database_load); each packet
+ * is deserialized from a slice of it, without copying, and its strings
+ * are borrowed from the buffer, which lives as long as the database.
+ * Packets are checked before deserialization (@see Database_read_record).
  * *deserialize* functions must be implemented by clients.
  * @see User.h
  * @see Activity.h
@@ -108,36 +144,25 @@ static void * App_deserialize(Database_T db,
 {
     if(!db || !deserialize)
         return NULL;
-    size_t sz = 0;
     Fifo_T fifo = NULL;
     void *data = NULL;
 
-// read/update: Open a file for update (both for input 
-// and output). The file must exist.
-    if( Database_open(db, "rb") )
-    {
-//        printf("\nFile exists!\n");
-/* Reading size of buffer to allocate and allocate */
-        if( !Database_read(db, &sz, sizeof(sz), SEEK_CUR))
-            return NULL;
-        fifo = Fifo_ctor(sz);
-/* Reading data to buffer to update idx externally */
-        if( !Database_read(db, Fifo_get_data(fifo), sz, SEEK_CUR) )
-            return NULL;
-        Fifo_set_write_idx(fifo, sz);
-/* Deserialize data and destroy buffer*/
-        data = deserialize(fifo);
-        Fifo_dtor(fifo);
-        return data;
-    }
-   return NULL; 
+/* Slicing the next valid packet from the buffer */
+    if( !(fifo = Database_read_record(db)) )
+        return NULL;
+/* Deserialize data and destroy the slice (not the buffer) */
+    data = deserialize(fifo);
+    Fifo_dtor(fifo);
+    return data;
 }
 
 /**
  * @brief Serializes a packet of generic data to the database
  * @param db: a constructed database
- * @param serialize: pointer to generic function capable of serializing the specific data of the database
+ * @param serialize: pointer to generic function capable of serializing the specific data of the database, appending it to a FIFO
  * @param data: packet of generic data to serialize
+ * @param buf: scratch FIFO, reused across calls; if NULL a temporary one 
+ * is used
  * @return true, if successfull; false otherwise
  *
  * *serialize* functions must be implemented by clients.
@@ -146,36 +171,322 @@ static void * App_deserialize(Database_T db,
  * @see Pack.h
  */
 static bool App_serialize(Database_T db,
-                          void * (*serialize)(Fifo_T fifo), 
-                          void *data)
+                          size_t (*serialize)(void *data, Fifo_T fifo), 
+                          void *data, Fifo_T buf)
 {
     if(!data || !db || !serialize)
         return false;
 
     size_t sz = 0;
-    Fifo_T fifo = NULL;
+    Fifo_T tmp = NULL;
+    bool ok = false;
 // read/update: Open a file for update (both for input 
 // and output). The file must exist.
     if( Database_open(db, "wb") )
     {
-/* Serialize pack */    
-        fifo = serialize(data);
-
-/* Update size of file beforehand (so fifo can be allocated on the
-   deserialization) */    
-//        sz = Fifo_get_size(fifo) + Database_get_size(db);
-//        printf("Serialize: sz = %zu", sz);
-//        print_msg_wait("Ser", -1);
-//        Database_write(db, &sz, sizeof(sz), SEEK_SET); 
-/* write size of object beforehand (so fifo can be allocated on the
-   deserialization) */    
-        sz = Fifo_get_size(fifo);
-        Database_write(db, &sz, sizeof(sz), SEEK_END); 
-/* write data */
-        Database_write(db, Fifo_get_data(fifo), sz, SEEK_END);
-        return true;
+        if(!buf)
+            buf = tmp = Fifo_ctor(0);
+/* Serialize packet into the emptied buffer */    
+        Fifo_reset(buf);
+/* write packet, framed by its size and checksum */
+        if( (sz = serialize(data, buf)) )
+            ok = Database_write_record(db, Fifo_get_data(buf), sz);
+/* A single packet: closing writes it, if it is pending in a block */
+        if(tmp)
+            Database_close(db);
+        Fifo_dtor(tmp);
+    }
+    return ok; 
+}
+
+/**
+ * @brief Deserializes every packet of the database into an array
+ * @param db: a constructed database
+ * @param deserialize: pointer to generic function capable of deserializing the specific data of the database
+ * @param n: filled with the nr. of packets read
+ * @return array of packets, to be freed by the caller
+ *
+ * With an offset table, the array is sized at once and every packet is
+ * found by its index (@see Database_read_nth); otherwise, the packets are 
+ * read in sequence and the array grown geometrically.
+ */
+static void ** App_read_all(Database_T db,
+                            void *( *deserialize)(Fifo_T fifo),
+                            unsigned *n)
+{
+    void **elems = NULL, **tmp, *data;
+    unsigned cap = Database_get_count(db);
+    Fifo_T fifo;
+
+    *n = 0;
+    if(cap)
+    {
+        elems = malloc(cap * sizeof(*elems));
+        assert(elems);
+        while( *n < cap && (fifo = Database_read_nth(db, *n)) )
+        {
+            data = deserialize(fifo);
+            Fifo_dtor(fifo);
+            if(!data)
+                break;
+            elems[(*n)++] = data;
+        }
+        return elems;
+    }
+    while( (data = App_deserialize(db, deserialize) ) != NULL)
+    {
+        if(*n == cap)
+        {
+            cap = cap ? 2 * cap : 64;
+            tmp = realloc(elems, cap * sizeof(*elems));
+            assert(tmp);
+            elems = tmp;
+        }
+        elems[(*n)++] = data;
+    }
+    return elems;
+}
+
+/**
+ * @brief Deserializes every packet of the database into a list
+ * @param db: a constructed database
+ * @param list: a pointer to a constructed (empty) list
+ * @param deserialize: pointer to generic function capable of deserializing the specific data of the database
+ * @param dtor: pointer to generic destructor of the specific data
+ *
+ * Packets are collected first and inserted with a single bulk build, which
+ * is linear for files written in order. Duplicated packets are destroyed.
+ * @see list.h
+ */
+static void App_load_list(Database_T db, List_T *list,
+                          void *( *deserialize)(Fifo_T fifo),
+                          void (*dtor)(void *data))
+{
+    unsigned n, kept;
+    void **elems = App_read_all(db, deserialize, &n);
+
+/* Bulk insert; rejected duplicates are returned at the end */
+    kept = List_build(list, elems, n);
+/* The list matches its file, unless duplicates were dropped */
+    List_set_dirty(*list, kept < n);
+    while(kept < n)
+        dtor(elems[kept++]);
+    free(elems);
+}
+
+/**
+ * @brief Deserializes every packet of the database into a vector
+ * @param db: a constructed database
+ * @param vec: a constructed (empty) vector
+ * @param deserialize: pointer to generic function capable of deserializing the specific data of the database
+ * @param dtor: pointer to generic destructor of the specific data
+ *
+ * @see App_load_list
+ * @see vec.h
+ */
+static void App_load_vec(Database_T db, Vec_T vec,
+                         void *( *deserialize)(Fifo_T fifo),
+                         void (*dtor)(void *data))
+{
+    unsigned n, kept;
+    void **elems = App_read_all(db, deserialize, &n);
+
+/* Bulk insert; rejected duplicates are returned at the end */
+    kept = Vec_build(vec, elems, n, false);
+/* The vector matches its file, unless duplicates were dropped */
+    Vec_set_dirty(vec, kept < n);
+    while(kept < n)
+        dtor(elems[kept++]);
+    free(elems);
+}
+
+/**
+ * @brief Gets the key of a user in the users' index
+ * @param user: a constructed User
+ * @param key: filled with the key: its username, in lowercase (usernames 
+ * compare case insensitively)
+ * @return true, if it can be indexed; false, otherwise (e.g., a username 
+ * too long)
+ */
+static bool App_index_key(const User_T user, char *key)
+{
+    const char *name = user_get_username(user);
+    size_t i;
+
+    if(!name || strlen(name) >= BTREE_KEY_SZ)
+        return false;
+    for(i = 0; name[i]; i++)
+        key[i] = tolower((unsigned char)name[i]);
+    key[i] = '\0';
+    return true;
+}
+
+/**
+ * @brief Drops a user from the users' index
+ * @param app: valid app instance
+ * @param user: a constructed User
+ */
+static void App_index_forget(App_T app, const User_T user)
+{
+    char key[BTREE_KEY_SZ];
+
+    if( app->user_index && user && App_index_key(user, key) )
+        BTree_del(app->user_index, key);
+}
+
+/**
+ * @brief Points a user's entry of the users' index at its last record
+ * @param app: valid app instance
+ * @param user: a constructed User
+ * @param loc: locator of the record; with INDEX_LOC_JOURNAL, in the journal
+ *
+ * If the entry cannot be updated, it is dropped: it would read an older 
+ * record of the user.
+ */
+static void App_index_put(App_T app, const User_T user, uint64_t loc)
+{
+    char key[BTREE_KEY_SZ];
+
+    if( app->user_index && user && App_index_key(user, key) && 
+        !BTree_put(app->user_index, key, loc) )
+        BTree_del(app->user_index, key);
+}
+
+/**
+ * @brief Reads a user alone, through the users' index
+ * @param app: valid app instance
+ * @param user: user with a name set
+ * @return the user, as in its last record (to be destructed by the 
+ * caller); NULL, if it is not indexed
+ *
+ * O(log n) page reads of the index and a single record read, either from
+ * the database or from the journal (a change not yet checkpointed).
+ */
+static User_T App_index_read(App_T app, const User_T user)
+{
+    char key[BTREE_KEY_SZ];
+    unsigned long long op, kind;
+    User_T rec = NULL, copy = NULL;
+    Fifo_T fifo;
+    uint64_t loc;
+
+    if( !app->user_index || !App_index_key(user, key) ||
+        !BTree_get(app->user_index, key, &loc) )
+        return NULL;
+    if( !(loc & INDEX_LOC_JOURNAL) )
+        fifo = Database_read_at(app->db_user, loc);
+/* Journaled: the record follows its operation and kind */
+    else if( (fifo = Database_read_at(app->db_journal, 
+                                      loc & ~INDEX_LOC_JOURNAL)) &&
+             !(Fifo_pop_uvar(fifo, &op) && op == J_Put && 
+               Fifo_pop_uvar(fifo, &kind) && kind == J_User) )
+    {
+        Fifo_dtor(fifo);
+        fifo = NULL;
+    }
+
+/* A stale locator reads another record (or none); the strings of the 
+   record are borrowed from the buffer: copy them */
+    if( (rec = user_deserialize(fifo)) && !user_cmp_username(rec, user) )
+    {
+        copy = user_ctor(user_get_type(rec));
+        user_clone(rec, copy);
+    }
+    if(rec)
+        user_dtor(rec);
+    Fifo_dtor(fifo);
+    return copy;
+}
+
+/**
+ * @brief Appends a change to the journal
+ * @param app: valid app instance
+ * @param op: operation
+ * @param kind: kind of the record
+ * @param data: record (user, activity or pack); for J_Del, only its key 
+ * matters
+ * @return true, if journaled; false, otherwise
+ *
+ * Changes are journaled as they happen, so a crash loses none of them: the
+ * journal is replayed on the next start (@see App_journal_replay). Each 
+ * change is a record of the journal's database: the operation, the kind 
+ * and the serialized record. Records are written whole (with their key), 
+ * so replaying a change twice leaves the same result.
+ * The records are made durable together, by App_journal_commit. The 
+ * container of the record is marked dirty, so the change is checkpointed.
+ * A user's entry of the users' index is pointed at its record in the 
+ * journal (or dropped, if removed), until the checkpoint rebuilds it.
+ */
+static bool App_journal(App_T app, enum App_journal_op op,
+                        enum App_journal_kind kind, const void *data)
+{
+    static size_t (* const serialize[])(void *data, Fifo_T fifo) = {
+        [J_User] = (void *)user_serialize_into,
+        [J_Act] = (void *)activity_serialize_into,
+        [J_Pack] = (void *)pack_serialize_into
+    };
+    Fifo_T buf = app->journal_buf;
+    uint64_t loc = 0;
+
+    if(!data)
+        return false;
+/* Its container must be saved at the next checkpoint, which empties the
+   journal */
+    switch(kind)
+    {
+        case J_User:
+            List_set_dirty(app->users, true);
+            loc = Database_tell_record(app->db_journal);
+            break;
+        case J_Act:
+            List_set_dirty(app->activities, true);
+            break;
+        case J_Pack:
+            Vec_set_dirty(app->packs, true);
+            break;
+    }
+
+    Fifo_reset(buf);
+    Fifo_push_uvar(buf, op);
+    Fifo_push_uvar(buf, kind);
+    serialize[kind]((void *)data, buf);
+    app->journal_ops++;
+    app->journal_unsynced = true;
+    if( !Database_write_record(app->db_journal, Fifo_get_data(buf),
+                               Fifo_get_write_idx(buf)) )
+    {
+        app->journal_failed = true; // reported by App_journal_commit
+        if(kind == J_User)
+            App_index_forget(app, (User_T)data); // its record is stale
+        return false;
     }
-   return false; 
+/* The users' index follows the changes: a user's last record is here */
+    if(kind == J_User && op == J_Put)
+        App_index_put(app, (User_T)data, loc | INDEX_LOC_JOURNAL);
+    else if(kind == J_User)
+        App_index_forget(app, (User_T)data);
+    return true;
+}
+
+/**
+ * @brief Makes the records appended to the journal durable
+ * @param app: valid app instance
+ * @return true, if successfull or there were none; false, otherwise (or
+ * a change since the last commit was not journaled)
+ *
+ * Group commit: the records of a whole step of the application (e.g., a 
+ * booking changes a user and an activity) share a single disk flush, so 
+ * its cost does not grow with the nr. of changes.
+ */
+static bool App_journal_commit(App_T app)
+{
+    bool failed = app->journal_failed;
+
+    app->journal_failed = false;
+    if(!app->journal_unsynced)
+        return !failed;
+    app->journal_unsynced = false;
+    return Database_sync(app->db_journal) && !failed;
 }
 
 /**
@@ -241,7 +552,8 @@ static List_T App_create_menus()
                           "Sair", NULL);
     
     Menu_T m11 = Menu_ctor(MENU_SEARCH_ACT,
-                          "Por Nome", "Por Data", "Sair", NULL);
+                          "Por Nome", "Por Data", "Por intervalo", "Sair",
+                          NULL);
 
 /* Insert menus in list */
     List_insert_ascend(&menus, m0, true, false, NULL);
@@ -279,8 +591,16 @@ static App_T App_ctor()
     app->state = S_Login;
     app->userdata = NULL;
     app->db_user = Database_ctor(DATABASE_USERS);
+    app->user_index = BTree_open(DATABASE_USERS_INDEX); // NULL: none
     app->db_act = Database_ctor(DATABASE_ACTIVITIES);
     app->db_pack = Database_ctor(DATABASE_PACKS);
+    app->db_journal = Database_ctor(DATABASE_JOURNAL);
+    app->journal_buf = Fifo_ctor(0);
+    app->journal_ops = 0;
+    app->journal_unsynced = app->journal_failed = false;
+/* Users and activities grow with history: keep them compressed */
+    Database_set_compressed(app->db_user, true);
+    Database_set_compressed(app->db_act, true);
 
     return app;
 }
@@ -303,16 +623,9 @@ static List_T App_load_users(Database_T db)
 
     User_T user1 = NULL, user2 = NULL, user3=NULL;
 
-// read/update: Open a file for update (both for input 
-// and output). The file must exist.
-/* Unpack pack objects from file and load them to list */
-    if( Database_open(db, "rb") )
-        while( (user1 = App_deserialize(db, (void *)user_deserialize) ) != NULL)
-        {
-            user_print_line(user1);
-            List_insert_ascend(&users, user1, true, false, NULL);
-            print_msg_wait("Hold\n", -1);
-        }
+/* Unpack user objects from file and load them to list */
+    if( Database_load(db) )
+        App_load_list(db, &users, (void *)user_deserialize, (void *)user_dtor);
     else
     { /* first execution */
 /* Construct Gerente, Func and Cliente */
@@ -328,10 +641,10 @@ static List_T App_load_users(Database_T db)
     List_insert_ascend(&users, user2, true, false, NULL);
     List_insert_ascend(&users, user3, true, false, NULL);
 /* Serialize and push to file */
-//    App_serialize(db, (void *)user_serialize, user1);
+//    App_serialize(db, (void *)user_serialize_into, user1, NULL);
     user_print_line(user2);
-    App_serialize(db, (void *)user_serialize, user2);
-//    App_serialize(db, (void *)user_serialize, user3);
+    App_serialize(db, (void *)user_serialize_into, user2, NULL);
+//    App_serialize(db, (void *)user_serialize_into, user3, NULL);
 
 //    List_print_all(users, (void *)user_print_line, true, table_header_user);
 
@@ -356,8 +669,11 @@ static List_T App_load_schedule(Database_T db)
                                   (void *)activity_print);
     Act_T act = NULL;
 /* Unpack activity objects from file and load them to list */
-    while( (act = App_deserialize(db, (void *)activity_deserialize) ) != NULL)
-        List_insert_ascend(&activities, act, true, false, NULL);
+    App_load_list(db, &activities, (void *)activity_deserialize,
+                  (void *)activity_dtor);
+/* Names are not unique, but are searched often: hash them */
+    List_add_index(activities, (void *)activity_cmp_name,
+                   (void *)activity_hash_name);
 #ifdef DEBUG
     if( !Database_open(db, "r+b") )
     {
@@ -373,7 +689,7 @@ static List_T App_load_schedule(Database_T db)
             print_msg_wait("Prima qq tecla para continuar", -1);
             List_insert_ascend(&activities, act, true, false, NULL);
 /* Serialize and push to file */
-            App_serialize(db, (void *)activity_serialize, act);
+            App_serialize(db, (void *)activity_serialize_into, act, NULL);
         }
     }
 #endif
@@ -383,21 +699,23 @@ static List_T App_load_schedule(Database_T db)
 /**
  * @brief Loads Packs from the database to the application
  * @param db: a constructed database
- * @return A list of Packs to be owned by App
+ * @return A vector of Packs to be owned by App
  *
- * If the database exists, it loads the Packs. Otherwise, returns NULL.
+ * If the database exists, it loads the Packs. Otherwise, returns an 
+ * empty vector.
+ * Packs are mostly read (listed and searched by name), so they are kept
+ * in a sorted array rather than a list.
  */
-static List_T App_load_packs(Database_T db)
+static Vec_T App_load_packs(Database_T db)
 {
-    List_T packs = List_ctor((void *)pack_ctor,
-                             (void *)pack_cmp_name, 
-                             (void *)pack_dtor, 
-                             (void *)pack_print);
-    Pack_T pack = NULL;
-/* Unpack pack objects from file and load them to list */
-    while( (pack = App_deserialize(db, (void *)pack_deserialize) ) != NULL)
-        List_insert_ascend(&packs , pack, true, false, NULL);
+    Vec_T packs = Vec_ctor((void *)pack_ctor,
+                           (void *)pack_cmp_name, 
+                           (void *)pack_dtor, 
+                           (void *)pack_print);
+/* Unpack pack objects from file and load them to vector */
+    App_load_vec(db, packs, (void *)pack_deserialize, (void *)pack_dtor);
 #ifdef TEST_PACK
+    Pack_T pack = NULL;
     if( !Database_open(db, "r+b") )
     {
 /* Construct pack */
@@ -408,14 +726,57 @@ static List_T App_load_packs(Database_T db)
         else
         {
 /* Serialize and push to file */
-            List_insert_ascend(&packs , pack, true, false, NULL);
-            App_serialize(db, (void *)pack_serialize, pack);
+            Vec_insert(packs, pack, false);
+            App_serialize(db, (void *)pack_serialize_into, pack, NULL);
         }
     }
 #endif
     return packs; 
 }
 
+/**
+ * @brief Gets the users list, loading it on first use
+ * @param app: valid app instance
+ * @return the users list
+ *
+ * A login reads its user alone (@see App_validate_user): the list is only
+ * loaded by the states that list or change users. A current user read 
+ * alone is swapped for its element of the list.
+ */
+static List_T App_users(App_T app)
+{
+    User_T user;
+
+    if(app->users)
+        return app->users;
+    app->users = App_load_users(app->db_user);
+    List_add_index(app->users, (void *)user_cmp_username,
+                   (void *)user_hash_username);
+/* A new (or unreadable) index: rebuilt by saving the users */
+    if( app->user_index && BTree_is_empty(app->user_index) )
+        List_set_dirty(app->users, true);
+    if(app->cur_user)
+    {
+        user = List_search(app->users, app->cur_user, NULL);
+        user_dtor(app->cur_user);
+        app->cur_user = user;
+    }
+    return app->users;
+}
+
+/**
+ * @brief Adds a user to the users list
+ * @param app: valid app instance
+ * @param user: a created user
+ * @return true, if added; false, if the username is already taken
+ */
+static bool App_add_user(App_T app, User_T user)
+{
+/* Usernames are unique: rejected by the list */
+    return ( List_insert_ascend(&(app->users), user, true, false, NULL) 
+             != NULL );
+}
+
 /**
  * @brief Checks if the user's credentials match in the database
  * @param app: valid app instance
@@ -423,12 +784,26 @@ static List_T App_load_packs(Database_T db)
  * @return user in database if password matches; else NULL
  *
  * It uses a user's with a name set to search the database. 
- * If found, it compares the passwords.
+ * If found, it compares the passwords. While the users list is not loaded,
+ * an indexed user is read alone, through the users' index (O(log n) page 
+ * reads), and it is returned as is (@see App_users); otherwise, the user 
+ * is searched in the users list, loaded if needed.
  */
 static User_T App_validate_user(App_T app, User_T user)
 {
+    User_T user_db = NULL;
+
+/* The users are not loaded: read the user alone */
+    if( !app->users && (user_db = App_index_read(app, user)) )
+    {
+        if( !strcmp(user_get_pass(user_db), user_get_pass(user)) )
+            return user_db;
+        user_dtor(user_db);
+        return NULL; // different password
+    }
+
 /* Search user in database (by username)*/
-    User_T user_db = List_search( app->users , user, NULL);
+    user_db = List_search( App_users(app) , user, NULL);
     if(user_db)
     {
         /* Check password */
@@ -440,7 +815,58 @@ static User_T App_validate_user(App_T app, User_T user)
 }
 
 /**
- * @brief Menu to search the provided =activities= list by name or by time.
+ * @brief Searches for an activity in a time interval
+ * @param activities: valid list of activities (sorted by time)
+ * @return activity chosen by the end user; NULL if none or aborted
+ *
+ * Prompts for the start and end of the interval [start, end), lists the 
+ * activities in it and lets the end user pick one by its number.
+ */
+static Act_T App_search_Act_range(const List_T activities)
+{
+    Act_T lo = activity_ctor(), hi = activity_ctor(), act = NULL;
+    List_View_T view = NULL;
+    char *input = NULL;
+    int val = 0;
+
+/* Prompt for the interval */
+    printf("\n------------ Inicio do intervalo ------------\n");
+    if( activity_set_time(lo) )
+    {
+        printf("\n-------------- Fim do intervalo -------------\n");
+        if( activity_set_time(hi) )
+            view = List_search_range(activities, lo, hi);
+    }
+    activity_dtor(lo);
+    activity_dtor(hi);
+    if( !List_View_count(view) )
+    {
+        List_View_dtor(view);
+        return NULL;
+    }
+
+/* Print the activities in the interval and choose one */
+    printf("\n-------------- Actividades -----------------\n");
+    List_View_print_all(view, (void *)activity_print_line, true,
+                        table_header_activity);
+    printf("---------------------------------------------\n");
+    do
+    {
+        input = get_input("Actividade (nr.): ");
+        if (input[0] == ABORT_INPUT) // check if user wants to abort
+            break;
+        val = validateInt(input);
+    } while ( (val < 1) || (val > (int)List_View_count(view)) );
+
+    if(input[0] != ABORT_INPUT)
+        act = List_View_get(view, val - 1);
+    List_View_dtor(view);
+    return act;
+}
+
+/**
+ * @brief Menu to search the provided =activities= list by name, by time or
+ * by time interval.
  * @param app: valid app instance
  * @param activities: valid list of activities
  * @param activity: activity found
@@ -475,6 +901,10 @@ static bool App_search_Act(const App_T app, const List_T activities,
                                (void *)activity_cmp_time);
         activity_dtor(act);
         break;
+    case 2: // search by time interval
+        activity_dtor(act);
+        *activity = App_search_Act_range(activities);
+        break;
     default: // Sair
         return false;
     }
@@ -524,7 +954,10 @@ static enum App_state App_Login(App_T app)
         return app->state;
     }
 
-/* User valid: Define current user */
+/* User valid: Define current user (the previous one, if read alone, is 
+   not in the users list) */
+    if(!app->users && app->cur_user && app->cur_user != user)
+        user_dtor(app->cur_user);
     app->cur_user = user;
     print_msg_wait("Valid user!", 1);
 
@@ -552,7 +985,7 @@ static enum App_state App_Gerente(App_T app)
     char resp;
     Menu_T menu = Menu_ctor(MENU_GERENTE, NULL);
     User_T func = NULL; 
-    List_T funcs = NULL;
+    List_View_T funcs = NULL;
 
 /* Define previous state */
     enum App_state prev_state = S_Logout;
@@ -568,14 +1001,15 @@ static enum App_state App_Gerente(App_T app)
 
 /* Retrieve list of employees */
     func = user_ctor(Func);
-    funcs = List_search_all(app->users, func, (void *)user_cmp_type);
+    funcs = List_query(App_users(app), func, (void *)user_cmp_type);
 
 /* Print all employes */
     if(resp == '4') 
     {
         printf("\n-------------- Funcionarios -----------------\n");
-        List_print_all(funcs, (void *)user_print_line, true, table_header_user);
+        List_View_print_all(funcs, (void *)user_print_line, true, table_header_user);
         printf("---------------------------------------------\n");
+        List_View_dtor(funcs);
         print_msg_wait("\nPrima qq tecla para continuar", -1);
         return app->state; // return to this state
     }
@@ -583,8 +1017,18 @@ static enum App_state App_Gerente(App_T app)
 /* Add user */
     if(resp == '0')
     {
-        user_create(func);
-        List_insert_ascend(&(app->users), func, true, false, NULL);
+        List_View_dtor(funcs);
+        if( !user_create(func) )
+        {
+            print_msg_wait("Insercao abortada!", 1);
+            return app->state; // return to this state
+        }
+        if( !App_add_user(app, func) )
+        {
+            print_msg_wait("Username ja existe! PF escolha outro!", 1);
+            return app->state; // return to this state
+        }
+        App_journal(app, J_Put, J_User, func);
         List_print_elem(app->users, func, NULL);
         print_msg_wait("Funcionario inserido", 1);
         return app->state; // return to this state
@@ -594,7 +1038,8 @@ static enum App_state App_Gerente(App_T app)
  * - Edit, List and Remove require a valid user */
     printf("\n-------------- Procurar Utilizador -----------------\n");
     user_set_username(func);
-    func = List_search(funcs, func, (void *)user_cmp_username);
+    func = List_View_search(funcs, func, (void *)user_cmp_username);
+    List_View_dtor(funcs);
     printf("\n----------------------------------------------------\n");
     if(!func)
     {
@@ -617,6 +1062,7 @@ static enum App_state App_Gerente(App_T app)
         printf("-------------------------------------------\n");
         break;
     default: // remove func
+        App_journal(app, J_Del, J_User, func);
         List_remove( &(app->users), func );
         print_msg_wait("Utilizador removido!", 1);
         break;
@@ -690,15 +1136,19 @@ static enum App_state App_Cliente(App_T app)
     switch(resp)
     {
     case '0': // Editar info
-/* Store the client found before jumping */
+/* Store the client found before jumping (an element of the users list) */
+        App_users(app);
         app->userdata = app->cur_user; 
         return S_Edit_User;
     case '1': // Carregar saldo
+        /* The balance is saved with the users list */
+        App_users(app);
         /* Current balance */
         printf("\nSaldo = %f [EURO]\n", user_get_saldo(app->cur_user));
         /* Update balance */
         if( user_set_saldo(app->cur_user) )
         {
+            App_journal(app, J_Put, J_User, app->cur_user);
             printf("\nSaldo actualizado!\n");
             printf("Saldo = %f [EURO]\n", user_get_saldo(app->cur_user));
         }
@@ -726,7 +1176,7 @@ static enum App_state App_Manage_Cli(App_T app)
     char resp;
     Menu_T menu = Menu_ctor(MENU_MANAGE_CLI, NULL);
     User_T cli = NULL; 
-    List_T clis = NULL;
+    List_View_T clis = NULL;
     
 /* Define previous state */
     enum App_state prev_state = S_Func;
@@ -742,14 +1192,15 @@ static enum App_state App_Manage_Cli(App_T app)
 
 /* Retrieve list of employees */
     cli = user_ctor(Cliente);
-    clis = List_search_all(app->users, cli, (void *)user_cmp_type);
+    clis = List_query(App_users(app), cli, (void *)user_cmp_type);
 
 /* Print all employees */
     if(resp == '4') 
     {
         printf("\n-------------- Clientes -----------------\n");
-        List_print_all(clis,  (void *)user_print_line, true, table_header_user);
+        List_View_print_all(clis,  (void *)user_print_line, true, table_header_user);
         printf("---------------------------------------------\n");
+        List_View_dtor(clis);
         print_msg_wait("\nPrima qq tecla para continuar", -1);
         return app->state; // return to this state
     }
@@ -757,12 +1208,18 @@ static enum App_state App_Manage_Cli(App_T app)
 /* Add user */
     if(resp == '0')
     {
+        List_View_dtor(clis);
         if( !user_create(cli) )
         {
             print_msg_wait("Insercao abortada!", 1);
             return app->state; // return to this state
         }
-        List_insert_ascend(&(app->users), cli, true, false, NULL);
+        if( !App_add_user(app, cli) )
+        {
+            print_msg_wait("Username ja existe! PF escolha outro!", 1);
+            return app->state; // return to this state
+        }
+        App_journal(app, J_Put, J_User, cli);
         List_print_elem(app->users, cli, NULL);
         print_msg_wait("Cliente inserido", 1);
         return app->state; // return to this state
@@ -772,7 +1229,8 @@ static enum App_state App_Manage_Cli(App_T app)
  * - Edit, List and Remove require a valid user */
     printf("\n-------------- Procurar Utilizador -----------------\n");
     user_set_username(cli);
-    cli = List_search(clis, cli, (void *)user_cmp_username);
+    cli = List_View_search(clis, cli, (void *)user_cmp_username);
+    List_View_dtor(clis);
     printf("\n----------------------------------------------------\n");
     if(!cli)
     {
@@ -795,6 +1253,7 @@ static enum App_state App_Manage_Cli(App_T app)
         printf("-------------------------------------------\n");
         break;
     default: // remove cli
+        App_journal(app, J_Del, J_User, cli);
         List_remove( &(app->users), cli );
         print_msg_wait("Utilizador removido!", 1);
         break;
@@ -852,7 +1311,10 @@ static enum App_state App_Manage_Act(App_T app)
         if( !List_insert_ascend(&(app->activities), act, true, false, NULL) )
             print_msg_wait("2 actividades no mesmo horario! PF insira novamente!", -1);
         else
+        {
+            App_journal(app, J_Put, J_Act, act);
             print_msg_wait("Actividade inserida!\n", -1);
+        }
         return app->state; // return to this state
     }
 
@@ -881,6 +1343,7 @@ static enum App_state App_Manage_Act(App_T app)
         printf("---------------------------------------------\n");
         break;
     default: // remove Act
+        App_journal(app, J_Del, J_Act, act);
         List_remove( &(app->activities), act );
         print_msg_wait("Actividade removida!", 1);
         break;
@@ -918,8 +1381,8 @@ static enum App_state App_Manage_Pack(App_T app)
     if(resp == '4') 
     {
         printf("\n-------------- Packs -----------------\n");
-        List_print_all(app->packs,  (void *)pack_print_line,
-                       false, table_header_pack);
+        Vec_print_all(app->packs,  (void *)pack_print_line,
+                      false, table_header_pack);
         printf("---------------------------------------------\n");
         print_msg_wait("\nPrima qq tecla para continuar", -1);
         return app->state; // return to this state
@@ -934,8 +1397,9 @@ static enum App_state App_Manage_Pack(App_T app)
             return app->state; // return to this state
         }
             
-        List_insert_ascend(&(app->packs), pack, true, false, NULL);
-        List_print_elem(app->packs, pack, NULL);
+        if( Vec_insert(app->packs, pack, false) )
+            App_journal(app, J_Put, J_Pack, pack);
+        Vec_print_elem(app->packs, pack, NULL);
         print_msg_wait("Pack inserido", 1);
         return app->state; // return to this state
     }
@@ -944,7 +1408,7 @@ static enum App_state App_Manage_Pack(App_T app)
  * - Edit, List and Remove require a valid activity */
     printf("\n-------------- Procurar Pack -----------------\n");
     pack_set_name(pack);
-    pack = List_search(app->packs, pack, NULL);
+    pack = Vec_search(app->packs, pack, NULL);
     printf("\n----------------------------------------------\n");
     if(!pack)
     {
@@ -962,12 +1426,13 @@ static enum App_state App_Manage_Pack(App_T app)
         return S_Edit_Pack;
     case '2': // List Pack
         printf("\n-------------- Pack -----------------\n");
-        List_print_elem(app->packs, pack, NULL);
+        Vec_print_elem(app->packs, pack, NULL);
         print_msg_wait("\nPrima qq tecla para continuar", -1);
         printf("---------------------------------------\n");
         break;
     default: // remove pack
-        List_remove( &(app->packs), pack );
+        App_journal(app, J_Del, J_Pack, pack);
+        Vec_remove(app->packs, pack);
         print_msg_wait("Pack removido!", 1);
         break;
     }
@@ -1036,20 +1501,33 @@ static enum App_state App_Edit_User(App_T app)
             return app->state; // return to this state
         }
 
+/* The username (sort and index key) is about to change: take it out */
+    if( resp == 0)
+    {
+        App_journal(app, J_Del, J_User, user);
+        List_remove( &(app->users), user );
+    }
+
 /* Copy back to original user */
     if( !user_clone(clone, user) )
     {
+        if( resp == 0)
+        {
+            List_insert_ascend(&(app->users), user, true, false, NULL);
+            App_journal(app, J_Put, J_User, user);
+        }
         print_msg_wait("Erro! PF tente outra vez!", 1);
         user_dtor(clone); 
         return app->state; // return to this state
     }
 
-/* If the username (sort key) was update, sort the list */
+/* If the username was updated, put it back in order */
     if( resp == 0)
-        List_sort( &app->users, NULL);
+        List_insert_ascend(&(app->users), user, true, false, NULL);
 
 /* User was updated; set dirty flag of list */
     List_set_dirty( app->users, true);
+    App_journal(app, J_Put, J_User, user);
         
     //user_dtor(clone);
     //menu_dtor(menu);
@@ -1118,20 +1596,33 @@ static enum App_state App_Edit_Act(App_T app)
             return app->state; // return to this state
         }
 
+/* The name or time (index keys) are about to change: take it out */
+    if( resp == 0 || resp == 1)
+    {
+        App_journal(app, J_Del, J_Act, activity);
+        List_remove( &(app->activities), activity );
+    }
+
 /* Copy back to original user */
     if( !activity_clone(clone, activity) )
     {
+        if( resp == 0 || resp == 1)
+        {
+            List_insert_ascend(&(app->activities), activity, true, false, NULL);
+            App_journal(app, J_Put, J_Act, activity);
+        }
         print_msg_wait("Erro! PF tente outra vez!", 1);
         activity_dtor(clone); 
         return app->state; // return to this state
     }
 
-/* If the time (sort key) was update, sort the list */
-    if( resp == 1)
-        List_sort( &app->activities, NULL);
+/* If the name or time were updated, put it back in order and indexed */
+    if( resp == 0 || resp == 1)
+        List_insert_ascend(&(app->activities), activity, true, false, NULL);
         
 /* Activity was updated; set dirty flag of list */
     List_set_dirty( app->activities, true);
+    App_journal(app, J_Put, J_Act, activity);
     //user_dtor(clone);
     //menu_dtor(menu);
     print_msg_wait("Dados editados", 1);
@@ -1188,25 +1679,32 @@ static enum App_state App_Edit_Pack(App_T app)
 
 /* If the username was update, check for conflicts */
     if( resp == 0)
-        if( List_search(app->packs, clone, NULL) ) // already in list
+        if( Vec_search(app->packs, clone, NULL) ) // already in list
         {
             print_msg_wait("Pack com este nome ja existe! PF escolha outro!", 1);
             return app->state; // return to this state
         }
 
+/* The name (key) is about to change: the old one is gone */
+    if( resp == 0)
+        App_journal(app, J_Del, J_Pack, pack);
+
 /* Copy back to original user */
     if( !pack_clone(clone, pack) )
     {
+        if( resp == 0)
+            App_journal(app, J_Put, J_Pack, pack);
         print_msg_wait("Erro! PF tente outra vez!", 1);
         return app->state; // return to this state
     }
 
 /* If the username (sort key) was update, sort the list */
     if( resp == 0)
-        List_sort( &app->packs, NULL);
+        Vec_sort(app->packs);
         
 /* Pack was updated; set dirty flag of list */
-    List_set_dirty( app->packs, true);
+    Vec_set_dirty( app->packs, true);
+    App_journal(app, J_Put, J_Pack, pack);
 
     //user_dtor(clone);
     //menu_dtor(menu);
@@ -1262,6 +1760,9 @@ static enum App_state App_Cli_Activities(App_T app)
         print_msg_wait("\nPrima qq tecla para continuar", -1);
         break;
     case 2: // Do reservation (in All)
+/* The user is changed (and linked to the activity): an element of the
+   users list */
+        App_users(app);
 /* Search for an activity in app->activities */
         if( !App_search_Act(app, app->activities, &act))
             break;
@@ -1283,8 +1784,12 @@ static enum App_state App_Cli_Activities(App_T app)
         user_add_activity(app->cur_user, act);
         /* Add user to activity's user */
         activity_add_user(act, app->cur_user);
+        /* Balance and vacancies changed */
+        App_journal(app, J_Put, J_User, app->cur_user);
+        App_journal(app, J_Put, J_Act, act);
         break;
     case 3: // Cancel reservation (in Mine)
+        App_users(app);
 /* Search for an activity in user->activities */
         if( !App_search_Act(app, user_get_activities(app->cur_user), &act))
             break;
@@ -1300,6 +1805,9 @@ static enum App_state App_Cli_Activities(App_T app)
         user_remove_activity(app->cur_user, act);
         /* Remove user from activity's user */
         activity_remove_user(act, app->cur_user);
+        /* Balance and vacancies changed */
+        App_journal(app, J_Put, J_User, app->cur_user);
+        App_journal(app, J_Put, J_Act, act);
         break;
     }
     return app->state; // return to this state
@@ -1411,48 +1919,264 @@ static enum App_state App_Logout(App_T app)
     return S_Login; // return to initial menu
 }
 
+/**
+ * @brief Context of App_save_record
+ */
+struct App_Save_T{
+    Database_T db; /**< database being written */
+    size_t (*serialize)(void *data, Fifo_T fifo); /**< record serializer */
+    void (*print)(void *data); /**< debug printer; may be NULL */
+    Fifo_T buf; /**< scratch buffer, reused by every record */
+    BTree_T index; /**< index rebuilt with the records; NULL if none */
+    bool (*key)(void *data, char *key); /**< key of a record in the index */
+};
+
+/**
+ * @brief Saves a record to the database
+ * @param data: record to save
+ * @param ctx: save context (struct App_Save_T)
+ *
+ * Used by App_save_database as a List_foreach/Vec_foreach callback.
+ */
+static void App_save_record(void *data, void *ctx)
+{
+    struct App_Save_T *save = ctx;
+    char key[BTREE_KEY_SZ];
+
+    if( save->index && save->key(data, key) )
+        BTree_load_add(save->index, key, Database_tell_record(save->db));
+    App_serialize(save->db, save->serialize, data, save->buf);
+    if(save->print)
+    {
+        save->print(data);
+        print_msg_wait("Wait\n", -1); 
+    }
+}
+
 /**
  * @brief Saves the database
  * @param db: a constructed database
- * @param list: a constructed list to save
+ * @param records: a constructed container (list or vector) to save
+ * @param foreach: traversal function of the container 
+ * (List_foreach or Vec_foreach)
  * @param serialize: pointer to generic function capable of serializing 
- * the specific data of the database
+ * the specific data of the database, appending it to a FIFO
  * @param print: pointer to generic function to debug info
+ * @param index: index of the records, rebuilt with the save; NULL if none
+ * @param key: pointer to function that gets the key of a record in the 
+ * index (the container must be in order of key); NULL if no index
+ * @return true, if saved; false, otherwise (the database is intact)
  *
  * Used to save users, activities and packs to the database.
+ * The container is only read, so it remains valid after the save.
+ * Every record is serialized into the same buffer, so a save allocates
+ * O(1) buffers, whatever the nr. of records. Records are coalesced in a 
+ * writer buffer of DATABASE_WBUF_SZ bytes, so a save takes a system call 
+ * per DATABASE_WBUF_SZ bytes written. @see Database_set_buffer
+ * The save is a new version of the database, synced once and renamed over
+ * it when complete, so a crash never leaves it torn. @see Database_commit
  * *serialize* functions must be implemented by clients.
  * *print* functions must be implemented by clients.
  * @see User.h
  * @see Activity.h
  * @see Pack.h
  */
-static void App_save_database(Database_T db, List_T list, 
-                              void * (*serialize)(Fifo_T fifo),
-                              void(*print)(void *data))
+static bool App_save_database(Database_T db, void *records, 
+                              void (*foreach)(void *records,
+                                              void (*fcn)(void *data,
+                                                          void *ctx),
+                                              void *ctx),
+                              size_t (*serialize)(void *data, Fifo_T fifo),
+                              void(*print)(void *data), BTree_T index,
+                              bool (*key)(void *data, char *key))
 {
-    void *data;
-    if(List_isDirty(list))
+    struct App_Save_T save = { db, serialize, print, Fifo_ctor(0), index, 
+                               key };
+    void *wbuf = malloc(DATABASE_WBUF_SZ);
+    bool ok;
+
+    /* Write a new version of the database */
+    Database_close(db);
+    Database_set_buffer(db, wbuf, DATABASE_WBUF_SZ);
+    if( (ok = Database_create(db)) )
     {
-        /* Reopen database and rewind list */
-        Database_close(db);
-        Database_open(db, "wb");
-        List_rewind(list);
-        /* While an user exists */
-        while ( (data = List_pop(list)) != NULL )
-        {
-            /* Serialize object to file and remove from the list */
-            App_serialize(db, serialize, data);
-            List_remove(&list, data);
-            List_rewind(list);
-            if(print)
+    /* Serialize every object to file, indexing their locators */
+        if( index && !BTree_load_begin(index) )
+            save.index = NULL;
+        foreach(records, App_save_record, &save);
+        ok = Database_commit(db);
+        if(save.index)
+            BTree_load_end(index, ok);
+    }
+    Database_set_buffer(db, NULL, 0);
+    free(wbuf);
+    Fifo_dtor(save.buf);
+    return ok;
+}
+
+/**
+ * @brief Applies a journaled change to a list
+ * @param list: a pointer to valid list, keyed by its default compare 
+ * function
+ * @param op: operation
+ * @param data: deserialized record; it is owned by the list or destructed
+ * @param dtor: pointer to generic destructor of the specific data
+ * @return true, if applied; false, if the record is invalid
+ *
+ * Idempotent: the record replaces the one with its key, if any.
+ */
+static bool App_replay_list(List_T *list, enum App_journal_op op, 
+                            void *data, void (*dtor)(void *data))
+{
+    void *found;
+
+    if(!data)
+        return false;
+    if( (found = List_search(*list, data, NULL)) )
+    {
+        List_remove(list, found);
+        dtor(found);
+    }
+    if( op != J_Put || !List_insert_ascend(list, data, true, false, NULL) )
+        dtor(data);
+    return true;
+}
+
+/**
+ * @brief Applies a journaled change to a vector
+ * @param vec: a valid vector, keyed by its default compare function
+ * @param op: operation
+ * @param data: deserialized record; it is owned by the vector or destructed
+ * @param dtor: pointer to generic destructor of the specific data
+ * @return true, if applied; false, if the record is invalid
+ * @see App_replay_list
+ */
+static bool App_replay_vec(Vec_T vec, enum App_journal_op op, 
+                           void *data, void (*dtor)(void *data))
+{
+    void *found;
+
+    if(!data)
+        return false;
+    if( (found = Vec_search(vec, data, NULL)) )
+    {
+        Vec_remove(vec, found);
+        dtor(found);
+    }
+    if( op != J_Put || !Vec_insert(vec, data, false) )
+        dtor(data);
+    return true;
+}
+
+/**
+ * @brief Replays the journal into the loaded databases
+ * @param app: valid app instance, with the databases loaded
+ * @return nr. of changes replayed
+ *
+ * Replaying stops at the first invalid record: a torn tail is the change
+ * that was being written when the process died. The replayed records 
+ * borrow their strings from the journal (@see Database_load).
+ */
+static unsigned App_journal_replay(App_T app)
+{
+    unsigned long long op, kind;
+    unsigned n = 0;
+    User_T user;
+    Fifo_T rec;
+    bool ok;
+
+    while( (rec = Database_read_record(app->db_journal)) )
+    {
+        ok = Fifo_pop_uvar(rec, &op) && op <= J_Del &&
+             Fifo_pop_uvar(rec, &kind);
+        if(ok)
+            switch(kind)
             {
-                print(data);
-                print_msg_wait("Wait\n", -1); 
+            case J_User:
+/* Its record is stale, even if the index missed the change */
+                App_index_forget(app, user = user_deserialize(rec));
+                App_users(app);
+                ok = App_replay_list(&(app->users), op, user,
+                                     (void *)user_dtor);
+                break;
+            case J_Act:
+                ok = App_replay_list(&(app->activities), op, 
+                                     activity_deserialize(rec),
+                                     (void *)activity_dtor);
+                break;
+            case J_Pack:
+                ok = App_replay_vec(app->packs, op, pack_deserialize(rec),
+                                    (void *)pack_dtor);
+                break;
+            default:
+                ok = false;
             }
-        }
-        
+        Fifo_dtor(rec);
+        if(!ok)
+            break;
+        n++;
     }
+    return n;
+}
 
+/**
+ * @brief Checkpoints the databases: saves the changed ones and empties the
+ * journal
+ * @param app: valid app instance
+ *
+ * The base files are committed (durably) before the journal is emptied, 
+ * so a crash in between only replays changes that are already saved 
+ * (which is harmless). If a save fails, the journal is kept.
+ * @return true, if every change is in the base files; false, otherwise
+ */
+static bool App_checkpoint(App_T app)
+{
+    bool ok = true;
+
+    if(app->users && List_isDirty(app->users))
+    {
+        if( App_save_database(app->db_user, app->users, (void *)List_foreach,
+                              (void *)user_serialize_into, 
+                              /*(void *)user_print_info*/ NULL,
+                              app->user_index, (void *)App_index_key) )
+            List_set_dirty(app->users, false);
+        else
+            ok = false;
+    }
+    if(List_isDirty(app->activities))
+    {
+        if( App_save_database(app->db_act, app->activities, 
+                              (void *)List_foreach,
+                              (void *)activity_serialize_into, NULL,
+                              NULL, NULL) )
+            List_set_dirty(app->activities, false);
+        else
+            ok = false;
+    }
+    if(Vec_isDirty(app->packs))
+    {
+        if( App_save_database(app->db_pack, app->packs, (void *)Vec_foreach,
+                              (void *)pack_serialize_into, NULL, NULL, 
+                              NULL) )
+            Vec_set_dirty(app->packs, false);
+        else
+            ok = false;
+    }
+/* The journal still counts: keep it, durable, and open to append the 
+   next changes (it is closed after the replay) */
+    if(!ok)
+    {
+        Database_open(app->db_journal, "ab");
+        App_journal_commit(app);
+        return false;
+    }
+
+/* Every change is in the base files: start an empty journal */
+    Database_reopen(app->db_journal, "wb");
+    Database_flush(app->db_journal);
+    app->journal_ops = 0;
+    app->journal_unsynced = app->journal_failed = false;
+    return true;
 }
 
 /**
@@ -1482,14 +2206,21 @@ App_T App_init()
 /* Construct app's memory */
     App_T app = App_ctor();
 
-/* Load users */
-    app->users = App_load_users(app->db_user);
+/* Users are loaded when needed (@see App_users); without an index, login
+   needs them */
+    if( !app->user_index || BTree_is_empty(app->user_index) )
+        App_users(app);
 
 /* Load schedule */
     app->activities = App_load_schedule(app->db_act);
 
 /* Load packs */
     app->packs = App_load_packs(app->db_pack);
+
+/* Redo the changes of the last execution, if it did not finish */
+    App_journal_replay(app);
+    if( !App_checkpoint(app) )
+        print_msg_wait("Erro ao guardar as bases de dados!", 1);
     
     return app;
 }
@@ -1499,17 +2230,26 @@ int App_exec(App_T app)
     while(1)
     {
         app->state = App_state_functions[app->state](app);
+/* The changes of the step are durable before the next one; otherwise, 
+   save them in the databases right away */
+        if( !App_journal_commit(app) )
+        {
+            print_msg_wait("Erro no registo de alteracoes!", 1);
+            App_checkpoint(app);
+        }
         if(app->state == S_Quit)
             break;
+/* Fold the journal into the databases once in a while */
+        if(app->journal_ops >= JOURNAL_CHECKPOINT)
+            App_checkpoint(app);
     }
 
 /* Exitted */
     /* Saving databases */
-    App_save_database(app->db_user, app->users, (void *)user_serialize, 
-                      /*(void *)user_print_info*/ NULL);
-    App_save_database(app->db_act, app->activities, 
-                      (void *)activity_serialize, NULL);
-    App_save_database(app->db_pack, app->packs, (void *)pack_serialize, NULL);
+    App_checkpoint(app);
+    Database_close(app->db_journal);
+    BTree_close(app->user_index);
+    app->user_index = NULL;
         
     /* Exitted -> print goodbye */
     print_msg_wait("Terminando aplicacao...", 1);
@@ -24,6 +24,9 @@ typedef struct App_T *App_T;
 /**
  * allocate dynamic memory and initialze App
  * @return initialized App_T
+ *
+ * The databases are loaded and the journal of changes of the last 
+ * execution, if it did not finish, is replayed into them.
  */
 App_T App_init();
 
@@ -33,9 +36,10 @@ App_T App_init();
  * @return an integer signaling the execution state
  *
  * Its the execution loop controlling the FSM machine behind the application's
- * logic. It starts in S_Login state. When end user quits the application,
- * the databases are saved, for future restoration at subsequent program
- * executions.
+ * logic. It starts in S_Login state. Every change is appended to a journal
+ * as it is made, and the journal is folded into the databases once in a 
+ * while and when end user quits the application, for future restoration 
+ * at subsequent program executions.
  */
 int App_exec(App_T app);
 /* ======================================================== */
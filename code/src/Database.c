@@ -10,8 +10,59 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <stdint.h>
 #include "Database.h"
+#include "crc32c.h"
+#include "lz.h"
+#include "page.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#define DB_POSIX /**< Files can be memory-mapped and written with writev */
+#include <errno.h>
+#include <limits.h> // IOV_MAX
+#include <fcntl.h> // open
+#include <unistd.h> // close, unlink, fdatasync
+#include <sys/mman.h> // mmap, madvise
+#include <sys/stat.h> // fstat
+#include <sys/uio.h> // writev
+#ifndef IOV_MAX
+#define IOV_MAX 1024 /**< Max. chunks per writev (Linux and BSD) */
+#endif
+#endif
+
+#define DB_MAGIC "EGDB" /**< First bytes of a database file */
+#define DB_MAGIC_SZ 4 /**< Nr. of bytes of DB_MAGIC (no terminator) */
+#define DB_REC_HDR_SZ 8 /**< Record header: length and CRC32C (32-bit each) */
+#define DB_BLK_HDR_SZ 8 /**< Block header: raw and compressed length */
+#define DB_TAB_MAGIC "EGTB" /**< Last bytes of a file with an offset table */
+#define DB_TAB_ENTRY_SZ 12 /**< Table entry: offset (64-bit) and length */
+#define DB_TAB_MARK_SZ 8 /**< End mark of the records (0xff) in a table */
+#define DB_TAB_TRAILER_SZ 20 /**< Table trailer: offset, count, CRC, magic */
+#define DB_BATCH 256 /**< Records per writev of Database_write_records */
+#define DB_TMP_EXT ".tmp" /**< Extension of the temp file of a new version */
+
+/* Paged database */
+#define DB_PAGED_MAGIC "EGPG" /**< First bytes of a paged database file */
+#define DB_PAGED_VERSION 1 /**< Format version of the paged database */
+#define DB_PAGED_HDR_SZ 12 /**< Header (page 0): magic, version, page size */
+#define DB_FSM_UNIT (DB_PAGE_SZ / 256) /**< Free space map: bytes per unit */
+#define DB_SLOT_BITS 10 /**< Bits of the slot in a record id */
+#define DB_ID(page, slot) ((uint32_t)(page) << DB_SLOT_BITS | (slot))
+#define DB_ID_PAGE(id) ((id) >> DB_SLOT_BITS) /**< Page of a record id */
+#define DB_ID_SLOT(id) ((id) & ((1u << DB_SLOT_BITS) - 1)) /**< Its slot */
+
+#ifdef DB_POSIX
+typedef struct iovec Database_Chunk; /**< piece of data to write */
+#else
+/**
+ * @brief Piece of data to write (as struct iovec)
+ */
+typedef struct
+{
+    void *iov_base; /**< data */
+    size_t iov_len; /**< length of data */
+} Database_Chunk;
+#endif
 
 /**
  * @brief Database's struct: contains the relevant data members
@@ -21,7 +72,24 @@ struct Database_T
     char *name; /**< name of the database */
     FILE *fp; /**< File pointer to the database */
     size_t size; /**< size of the database */
-//    fifo_T fifo; /**< FIFO buffer for packing/unpacking data*/
+    Fifo_T buf; /**< contents of the database, loaded in one go */
+    unsigned flags; /**< flags of the files written (DB_FLAG_*) */
+    Fifo_T block; /**< compressed database: records of the pending block */
+    Fifo_T zbuf; /**< compressed database: scratch for compression */
+    void *map; /**< read-only mapping of the file; NULL if not mapped */
+    size_t map_sz; /**< length of the mapping */
+    unsigned char *wbuf; /**< buffered writer: user-supplied buffer */
+    size_t wbuf_sz; /**< size of wbuf; 0 if unbuffered */
+    size_t wbuf_len; /**< bytes pending in wbuf */
+    char *tmp; /**< temp file of the new version; NULL if none */
+    Fifo_T new_table; /**< offset table of the new version; NULL if none */
+    size_t recs_len; /**< length of the records of the new version */
+    Fifo_T table; /**< offset table of the loaded records; NULL if none */
+    size_t recs_base; /**< offset of the loaded records in buf */
+    unsigned char *page; /**< paged: buffer of a page; NULL if not paged */
+    uint32_t page_no; /**< paged: nr. of the page in the buffer; 0 if none */
+    uint32_t nr_pages; /**< paged: nr. of pages, the header's included */
+    unsigned char *fsm; /**< paged: free space map (DB_FSM_UNITs a page) */
 };
 
 /**
@@ -38,6 +106,390 @@ static Database_T Database_new()
     return db;
 }
 
+/**
+ * @brief Stores a 32-bit value in little-endian order
+ * @param p: destination (4 bytes)
+ * @param val: value to store
+ */
+static void Database_put_u32(unsigned char *p, uint32_t val)
+{
+    p[0] = val; p[1] = val >> 8; p[2] = val >> 16; p[3] = val >> 24;
+}
+
+/**
+ * @brief Loads a 32-bit value stored in little-endian order
+ * @param p: source (4 bytes)
+ * @return value
+ */
+static uint32_t Database_get_u32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | 
+           (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * @brief Writes chunks of data to the file, bypassing its stdio buffer
+ * @param db: a valid, opened Database
+ * @param iov: chunks to write; it is changed
+ * @param n: nr. of chunks
+ * @return true, if successfull; false, otherwise
+ *
+ * A single writev, unless the kernel takes less than everything.
+ */
+static bool Database_writev_all(const Database_T db, Database_Chunk *iov,
+                                size_t n)
+{
+#ifdef DB_POSIX
+    int fd = fileno(db->fp);
+    ssize_t wr;
+
+    fflush(db->fp); // whatever was written through stdio goes first
+    while(n)
+    {
+        if( (wr = writev(fd, iov, n < IOV_MAX ? n : IOV_MAX)) < 0 )
+        {
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+/* Skip what was written */
+        for(; n && (size_t)wr >= iov->iov_len; iov++, n--)
+            wr -= iov->iov_len;
+        if(n)
+        {
+            iov->iov_base = (unsigned char *)iov->iov_base + wr;
+            iov->iov_len -= wr;
+        }
+    }
+    return true;
+#else
+    for(; n; iov++, n--)
+        if( iov->iov_len && 
+            fwrite(iov->iov_base, iov->iov_len, 1, db->fp) != 1 )
+            return false;
+    return true;
+#endif
+}
+
+/**
+ * @brief Appends chunks of data to the end of the file
+ * @param db: a valid Database
+ * @param iov: chunks to write, from iov[1]: iov[0] is reserved for the 
+ * pending data of the buffered writer; it is changed
+ * @param n: nr. of chunks, including iov[0]
+ * @return true, if successfull; false, otherwise
+ *
+ * Buffered: the chunks are copied to the buffer if they fit; otherwise, 
+ * the pending data and the chunks are written at once, with no copy.
+ */
+static bool Database_put(const Database_T db, Database_Chunk *iov, size_t n)
+{
+    size_t i, len = 0;
+
+    if(!db->fp)
+        return false; // file needs to be open first
+    for(i = 1; i < n; i++)
+        len += iov[i].iov_len;
+    db->size += len;
+
+/* Unbuffered: one seek, then stdio */
+    if(!db->wbuf_sz)
+    {
+        fseek(db->fp, 0, SEEK_END);
+        for(i = 1; i < n; i++)
+            if( iov[i].iov_len && 
+                fwrite(iov[i].iov_base, iov[i].iov_len, 1, db->fp) != 1 )
+                return false;
+        return true;
+    }
+
+/* Buffered: coalesced while they fit */
+    if(db->wbuf_len + len <= db->wbuf_sz)
+    {
+        for(i = 1; i < n; i++)
+        {
+            memcpy(db->wbuf + db->wbuf_len, iov[i].iov_base, iov[i].iov_len);
+            db->wbuf_len += iov[i].iov_len;
+        }
+        return true;
+    }
+    iov[0].iov_base = db->wbuf;
+    iov[0].iov_len = db->wbuf_len;
+    db->wbuf_len = 0;
+    return Database_writev_all(db, iov, n);
+}
+
+/**
+ * @brief Compresses and writes the pending block of records
+ * @param db: a valid Database
+ * @return true, if successfull or nothing was pending; false, otherwise
+ */
+static bool Database_flush_block(const Database_T db)
+{
+    unsigned char hdr[DB_BLK_HDR_SZ];
+    size_t raw, comp;
+    const void *data;
+    bool ok;
+
+    if(!db->fp || !db->block || !(raw = Fifo_get_write_idx(db->block)))
+        return true;
+
+    if(!db->zbuf)
+        db->zbuf = Fifo_ctor(0);
+    Fifo_reserve(db->zbuf, LZ_bound(raw));
+/* Store it as is, if it does not shrink */
+    comp = LZ_compress(Fifo_get_data(db->block), raw, 
+                       Fifo_get_data(db->zbuf), raw - 1);
+    data = comp ? Fifo_get_data(db->zbuf) : Fifo_get_data(db->block);
+    if(!comp)
+        comp = raw;
+    Database_put_u32(hdr, raw);
+    Database_put_u32(hdr + 4, comp);
+    ok = Database_write(db, hdr, sizeof(hdr), SEEK_END) &&
+         Database_write(db, data, comp, SEEK_END);
+    Fifo_reset(db->block);
+    return ok;
+}
+
+/**
+ * @brief Adds a record to the offset table of the new version, if any
+ * @param db: a valid Database
+ * @param sz: length of the record
+ *
+ * Its offset is in the records, as loaded (i.e., decompressed).
+ */
+static void Database_table_add(const Database_T db, size_t sz)
+{
+    unsigned char ent[DB_TAB_ENTRY_SZ];
+
+    if(!db->new_table)
+        return;
+    Database_put_u32(ent, (uint32_t)db->recs_len);
+    Database_put_u32(ent + 4, (uint32_t)((uint64_t)db->recs_len >> 32));
+    Database_put_u32(ent + 8, sz);
+    Fifo_push(db->new_table, ent, sizeof(ent));
+    db->recs_len += DB_REC_HDR_SZ + sz;
+}
+
+/**
+ * @brief Writes the offset table of the new version, after its records
+ * @param db: a valid Database, created by Database_create
+ * @return true, if successfull; false, otherwise
+ */
+static bool Database_write_table(const Database_T db)
+{
+    unsigned char mark[DB_TAB_MARK_SZ], trl[DB_TAB_TRAILER_SZ];
+    size_t len = Fifo_get_write_idx(db->new_table);
+    uint64_t off;
+
+    if( !Database_flush_block(db) )
+        return false;
+    off = db->size; // where the table starts
+/* An invalid record (and block) header: sequential readers stop there */
+    memset(mark, 0xff, sizeof(mark));
+    Database_put_u32(trl, (uint32_t)off);
+    Database_put_u32(trl + 4, (uint32_t)(off >> 32));
+    Database_put_u32(trl + 8, len / DB_TAB_ENTRY_SZ);
+    Database_put_u32(trl + 12, crc32c(0, Fifo_get_data(db->new_table), len));
+    memcpy(trl + 16, DB_TAB_MAGIC, DB_MAGIC_SZ);
+    return Database_write(db, mark, sizeof(mark), SEEK_END) &&
+           Database_write(db, Fifo_get_data(db->new_table), len, SEEK_END) &&
+           Database_write(db, trl, sizeof(trl), SEEK_END);
+}
+
+/**
+ * @brief Decompresses the blocks of a loaded, compressed database
+ * @param raw: contents of the file, after the header
+ * @return contents of the database, i.e., the framed records; the blocks
+ * after an invalid one are dropped
+ */
+static Fifo_T Database_inflate(const Fifo_T raw)
+{
+    Fifo_T out = Fifo_ctor(0);
+    const unsigned char *hdr, *blk;
+    size_t len, comp, wr;
+
+    while( (hdr = Fifo_view(raw, DB_BLK_HDR_SZ)) )
+    {
+        len = Database_get_u32(hdr);
+        comp = Database_get_u32(hdr + 4);
+        if( !(blk = Fifo_view(raw, comp)) )
+            break; // torn block
+        wr = Fifo_get_write_idx(out);
+        Fifo_reserve(out, wr + len);
+        if(comp == len)
+            memcpy((unsigned char *)Fifo_get_data(out) + wr, blk, len);
+        else if( LZ_decompress(blk, comp, (unsigned char *)Fifo_get_data(out)
+                               + wr, len) != len )
+            break; // corrupted block
+        Fifo_set_write_idx(out, wr + len);
+    }
+    Fifo_set_version(out, Fifo_get_version(raw));
+    return out;
+}
+
+/**
+ * @brief Releases the mapping of the database, if any
+ * @param db: a valid Database
+ */
+static void Database_unmap(const Database_T db)
+{
+#ifdef DB_POSIX
+    if(db->map)
+        munmap(db->map, db->map_sz);
+#endif
+    db->map = NULL;
+    db->map_sz = 0;
+}
+
+/**
+ * @brief Prepares the database's file to be created anew
+ * @param db: a valid Database
+ * @param fmt: format the file is going to be opened with
+ *
+ * Truncating a mapped file would take away the data the loaded records 
+ * borrow: it is unlinked instead, so the mapping keeps the old file.
+ */
+static void Database_detach(const Database_T db, const char *fmt)
+{
+#ifdef DB_POSIX
+    if(db->map && fmt[0] == 'w')
+        unlink(db->name);
+#endif
+}
+
+/**
+ * @brief Makes the entries of the database's directory durable (e.g., a 
+ * rename)
+ * @param db: a valid Database
+ * @return true, if successfull; false, otherwise
+ */
+static bool Database_sync_dir(const Database_T db)
+{
+#ifdef DB_POSIX
+    const char *slash = strrchr(db->name, '/');
+    size_t len = (slash ? slash - db->name + 1 : 0);
+    char *dir;
+    int fd;
+    bool ok;
+
+    if(!len)
+        fd = open(".", O_RDONLY);
+    else
+    { // up to the last slash
+        dir = malloc(len + 1);
+        assert(dir);
+        memcpy(dir, db->name, len);
+        dir[len] = '\0';
+        fd = open(dir, O_RDONLY);
+        free(dir);
+    }
+    if(fd < 0)
+        return false;
+    ok = !fsync(fd);
+    close(fd);
+    return ok;
+#else
+    return true;
+#endif
+}
+
+/**
+ * @brief Parses the offset table at the end of the loaded database
+ * @param db: a valid Database, whose buf has the contents of the file
+ * @param start: offset of the first record (or block) in buf
+ *
+ * If it is valid, it is kept and buf ends where it starts; otherwise 
+ * (e.g., a corrupted file), there is none.
+ */
+static void Database_parse_table(const Database_T db, size_t start)
+{
+    const unsigned char *data = Fifo_get_data(db->buf), *trl;
+    size_t end = Fifo_get_write_idx(db->buf), len;
+    uint64_t off;
+
+    if(end - start < DB_TAB_MARK_SZ + DB_TAB_TRAILER_SZ)
+        return;
+    end -= DB_TAB_TRAILER_SZ;
+    trl = data + end;
+    off = Database_get_u32(trl) | (uint64_t)Database_get_u32(trl + 4) << 32;
+    if( memcmp(trl + 16, DB_TAB_MAGIC, DB_MAGIC_SZ) || off < start ||
+        off > end - DB_TAB_MARK_SZ || 
+        (len = end - off - DB_TAB_MARK_SZ) % DB_TAB_ENTRY_SZ || 
+        len / DB_TAB_ENTRY_SZ != Database_get_u32(trl + 8) ||
+        crc32c(0, data + off + DB_TAB_MARK_SZ, len) != 
+        Database_get_u32(trl + 12) )
+        return;
+    db->table = Fifo_ctor(len);
+    Fifo_push(db->table, data + off + DB_TAB_MARK_SZ, len);
+    Fifo_set_write_idx(db->buf, off); // the records end there
+}
+
+/**
+ * @brief Parses the header of the loaded database
+ * @param db: a valid Database, whose buf has the contents of the file
+ * @return buf, past the header; NULL if the format is unknown (buf is 
+ * released)
+ */
+static Fifo_T Database_parse_header(const Database_T db)
+{
+    unsigned long long version, flags = 0;
+    size_t start;
+    Fifo_T raw;
+
+/* Header: magic and version; legacy files have none */
+    if( Fifo_get_write_idx(db->buf) >= DB_MAGIC_SZ && 
+        !memcmp(Fifo_get_data(db->buf), DB_MAGIC, DB_MAGIC_SZ) )
+    {
+        Fifo_view(db->buf, DB_MAGIC_SZ);
+        if( !(start = Fifo_pop_uvar(db->buf, &version)) || 
+            version > FIFO_VERSION || (version >= FIFO_VERSION_FLAGS && 
+             !(start = Fifo_pop_uvar(db->buf, &flags))) || 
+            (flags & ~(DB_FLAG_LZ | DB_FLAG_TABLE)) )
+        {
+            Fifo_dtor(db->buf);
+            Database_unmap(db);
+            return (db->buf = NULL); // unknown format: do not load it
+        }
+        Fifo_set_version(db->buf, version);
+        db->recs_base = start;
+        if(flags & DB_FLAG_TABLE)
+            Database_parse_table(db, start);
+/* Compressed: the records are the decompressed blocks */
+        if(flags & DB_FLAG_LZ)
+        {
+            db->recs_base = 0;
+            raw = db->buf;
+            db->buf = Database_inflate(raw);
+            Fifo_dtor(raw);
+            Database_unmap(db); // no longer required
+        }
+    }
+    else
+        Fifo_set_version(db->buf, FIFO_VERSION_LEGACY);
+    return db->buf;
+}
+
+/**
+ * @brief Writes the header to a database opened for writing
+ * @param db: a valid, opened Database
+ * @param flags: flags of the file (DB_FLAG_*)
+ * @return true, if successfull; false, otherwise
+ */
+static bool Database_write_header(const Database_T db, unsigned flags)
+{
+    Fifo_T hdr = Fifo_ctor(DB_MAGIC_SZ + FIFO_VARINT_MAX);
+    bool ok;
+
+    Fifo_push(hdr, DB_MAGIC, DB_MAGIC_SZ);
+    Fifo_push_uvar(hdr, FIFO_VERSION);
+    Fifo_push_uvar(hdr, flags);
+    ok = Database_write(db, Fifo_get_data(hdr), Fifo_get_write_idx(hdr), 
+                        SEEK_END);
+    Fifo_dtor(hdr);
+    return ok;
+}
+
 Database_T Database_ctor(const char *name)
 {
 /* Construct instance */
@@ -47,6 +499,18 @@ Database_T Database_ctor(const char *name)
     db->name = malloc(strlen(name) + 1);
     strcpy(db->name, name);
     db->size = 0;
+    db->buf = NULL;
+    db->flags = 0;
+    db->block = db->zbuf = NULL;
+    db->map = NULL;
+    db->map_sz = 0;
+    db->wbuf = NULL;
+    db->wbuf_sz = db->wbuf_len = 0;
+    db->tmp = NULL;
+    db->new_table = db->table = NULL;
+    db->recs_len = db->recs_base = 0;
+    db->page = db->fsm = NULL;
+    db->page_no = db->nr_pages = 0;
     return db;
 }
 
@@ -54,24 +518,53 @@ void Database_dtor(Database_T db)
 {
     if(db->name)
         free(db->name);
+    Fifo_dtor(db->buf);
+    Fifo_dtor(db->block);
+    Fifo_dtor(db->zbuf);
+    Database_unmap(db);
+    free(db->tmp);
+    Fifo_dtor(db->new_table);
+    Fifo_dtor(db->table);
+    free(db->page);
+    free(db->fsm);
     free(db);
 }
 
 bool Database_open(const Database_T db, const char *fmt)
 {
+    long end;
+
     if(db->fp)
         return true; // already opened
 
     // a+b append in binary mode
     // w+b write&read in binary mode
 /* Try to open the file to read and write in binary mode */
+    Database_detach(db, fmt);
     db->fp = fopen(db->name, fmt);
+/* Appending: the records are located from where the file ends */
+    if( db->fp && fmt[0] == 'a' && !fseek(db->fp, 0, SEEK_END) && 
+        (end = ftell(db->fp)) > 0 )
+        db->size = end;
+/* A new (or empty) file: starts with the header */
+    if( db->fp && (fmt[0] == 'w' || (fmt[0] == 'a' && !db->size)) )
+        return Database_write_header(db, db->flags);
 
     return (db->fp ? true : false);
 }
 
+void Database_set_compressed(const Database_T db, bool compressed)
+{
+    if(compressed)
+        db->flags |= DB_FLAG_LZ;
+    else
+        db->flags &= ~DB_FLAG_LZ;
+}
+
 bool Database_reopen(const Database_T db, const char *fmt)
 {
+    long end;
+
     if(db->fp)
         if( !Database_close(db))
             return false; // already opened
@@ -82,7 +575,15 @@ bool Database_reopen(const Database_T db, const char *fmt)
     // a+b append in binary mode
     // w+b write&read in binary mode
 /* Try to open the file to read and write in binary mode */
+    Database_detach(db, fmt);
     db->fp = fopen(db->name, fmt);
+/* Appending: the records are located from where the file ends */
+    if( db->fp && fmt[0] == 'a' && !fseek(db->fp, 0, SEEK_END) && 
+        (end = ftell(db->fp)) > 0 )
+        db->size = end;
+/* A new (or empty) file: starts with the header */
+    if( db->fp && (fmt[0] == 'w' || (fmt[0] == 'a' && !db->size)) )
+        return Database_write_header(db, db->flags);
 
     return (db->fp ? true : false);
 }
@@ -98,13 +599,119 @@ bool Database_reopen(const Database_T db, const char *fmt)
 //    db->fifo = fifo_ctor(sz);
 //}
 
+bool Database_create(const Database_T db)
+{
+    if(db->fp)
+        if( !Database_close(db) )
+            return false;
+    db->size = 0;
+
+/* The new version is written aside: the database is intact until commit */
+    db->tmp = malloc(strlen(db->name) + sizeof(DB_TMP_EXT));
+    assert(db->tmp);
+    strcpy(db->tmp, db->name);
+    strcat(db->tmp, DB_TMP_EXT);
+    if( !(db->fp = fopen(db->tmp, "wb")) )
+    {
+        free(db->tmp);
+        db->tmp = NULL;
+        return false;
+    }
+/* Written whole: its records are indexed by an offset table */
+    db->new_table = Fifo_ctor(0);
+    db->recs_len = 0;
+    return Database_write_header(db, db->flags | DB_FLAG_TABLE);
+}
+
+bool Database_sync(const Database_T db)
+{
+    if(!db->fp)
+        return false; // file needs to be open first
+/* Everything written so far, down to the disk */
+    if( !Database_flush_block(db) || !Database_flush(db) )
+        return false;
+#if defined(__linux__)
+    return !fdatasync(fileno(db->fp)); // the data; not every metadata
+#elif defined(DB_POSIX)
+    return !fsync(fileno(db->fp));
+#else
+    return true;
+#endif
+}
+
+bool Database_commit(const Database_T db)
+{
+    char *tmp = db->tmp;
+    bool ok;
+
+    if(!db->fp || !tmp)
+        return false; // not created
+    db->tmp = NULL; // so closing keeps it
+
+/* Durable first, then put in place at once: the old or the new version */
+    ok = Database_write_table(db) && Database_sync(db);
+    ok = Database_close(db) && ok;
+    ok = ok && !rename(tmp, db->name);
+    if(ok)
+        ok = Database_sync_dir(db);
+    else
+        remove(tmp);
+    free(tmp);
+    return ok;
+}
+
+bool Database_set_buffer(const Database_T db, void *buf, size_t sz)
+{
+    bool ok = Database_flush(db);
+
+    db->wbuf = buf;
+    db->wbuf_sz = (buf ? sz : 0);
+    return ok;
+}
+
+bool Database_flush(const Database_T db)
+{
+    Database_Chunk iov[1];
+
+    if(!db->fp)
+        return true;
+    if(!db->wbuf_len)
+        return !fflush(db->fp); // unbuffered: stdio's buffer
+    iov[0].iov_base = db->wbuf;
+    iov[0].iov_len = db->wbuf_len;
+    db->wbuf_len = 0;
+    return Database_writev_all(db, iov, 1);
+}
+
 bool Database_close(const Database_T db)
 {
+/* Pending records are written before closing */
+    Database_flush_block(db);
+    Database_flush(db);
     db->size = 0;
+    Fifo_dtor(db->new_table);
+    db->new_table = NULL;
+/* Paged: the buffered page and the free space map are gone */
+    free(db->page);
+    free(db->fsm);
+    db->page = db->fsm = NULL;
+    db->page_no = db->nr_pages = 0;
     // fclose should only be called if the fp returned by fopen is != NULL
     // using fclose on a NULL ptr will cause undefined behaviour
     if(db->fp)
-        return !fclose(db->fp);
+    {
+        FILE *fp = db->fp;
+        db->fp = NULL; // so it can be opened again
+        if(db->tmp)
+        { // a new version that was not committed: abandoned
+            fclose(fp);
+            remove(db->tmp);
+            free(db->tmp);
+            db->tmp = NULL;
+            return true;
+        }
+        return !fclose(fp);
+    }
     return false; // cannot close an unopened file
 }
 
@@ -120,8 +727,8 @@ void Database_rewind(const Database_T db)
 
 bool Database_read(const Database_T db, void *elem, size_t sz, int origin)
 {
-    if(! db->fp)
-        return false; // file needs to be open first
+    if(! db->fp || !Database_flush(db))
+        return false; // file needs to be open first; pending data written
 
     fseek(db->fp, 0, origin);
 
@@ -137,21 +744,602 @@ bool Database_read(const Database_T db, void *elem, size_t sz, int origin)
 bool Database_write(const Database_T db, const void *elem, 
                     size_t sz, int origin)
 {    
+    Database_Chunk iov[2];
+
     if(! db->fp)
         return false; // file needs to be open first
+/* Appending: buffered, with no seek */
+    if(origin == SEEK_END)
+    {
+        iov[1].iov_base = (void *)elem;
+        iov[1].iov_len = sz;
+        return Database_put(db, iov, 2);
+    }
+    if( !Database_flush(db) )
+        return false; // pending data goes first
 
     fseek(db->fp, 0, origin);
 
-/* Writing to end of the file, increases its size */
-    if(origin == SEEK_END)
-        db->size += sz;
-
     static size_t nr_elems = 1;
 /* size_t fwrite(const void *ptr, size_t size, size_t nmemb, FILE *stream) */
     return ( (fwrite(elem, sz, nr_elems, db->fp) ) == nr_elems );
 }
 
+Fifo_T Database_map(const Database_T db)
+{
+#ifdef DB_POSIX
+    struct stat st;
+    void *map;
+    int fd;
+
+    if(db->buf)
+        return db->buf; // already loaded
+
+    if( (fd = open(db->name, O_RDONLY)) < 0 )
+        return NULL;
+/* Empty files cannot be mapped */
+    if( fstat(fd, &st) || st.st_size <= 0 ||
+        (map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) ==
+        MAP_FAILED )
+    {
+        close(fd);
+        return NULL;
+    }
+    close(fd); // the mapping remains valid
+/* Read once, front to back: let the kernel read ahead */
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    db->map = map;
+    db->map_sz = st.st_size;
+    db->buf = Fifo_borrow(map, st.st_size);
+    return Database_parse_header(db);
+#else
+    return NULL;
+#endif
+}
+
+Fifo_T Database_load(const Database_T db)
+{
+    FILE *fp;
+    long sz;
+
+    if(db->buf)
+        return db->buf; // already loaded
+/* Map it, if possible */
+    if( Database_map(db) )
+        return db->buf;
+
+/* Otherwise, read the whole file at once */
+    if( !(fp = fopen(db->name, "rb")) )
+        return NULL;
+    if( fseek(fp, 0, SEEK_END) || (sz = ftell(fp)) < 0 )
+    {
+        fclose(fp);
+        return NULL;
+    }
+    rewind(fp);
+    db->buf = Fifo_ctor(sz);
+    if( sz && fread(Fifo_get_data(db->buf), sz, 1, fp) != 1 )
+        sz = 0; // unreadable: load nothing
+    Fifo_set_write_idx(db->buf, sz);
+    fclose(fp);
+    return Database_parse_header(db);
+}
+
+bool Database_write_record(const Database_T db, const void *rec, size_t sz)
+{
+    unsigned char hdr[DB_REC_HDR_SZ];
+    Database_Chunk iov[3];
+
+    if(!rec || sz > UINT32_MAX)
+        return false;
+    Database_table_add(db, sz);
+/* Header: length and CRC32C of the record */
+    Database_put_u32(hdr, sz);
+    Database_put_u32(hdr + 4, crc32c(0, rec, sz));
+    if( !(db->flags & DB_FLAG_LZ) )
+    {
+        iov[1].iov_base = hdr;
+        iov[1].iov_len = sizeof(hdr);
+        iov[2].iov_base = (void *)rec;
+        iov[2].iov_len = sz;
+        return Database_put(db, iov, 3);
+    }
+
+/* Compressed: buffered in the pending block */
+    if(!db->fp)
+        return false; // file needs to be open first
+    if(!db->block)
+        db->block = Fifo_ctor(DB_BLOCK_SZ);
+    Fifo_push(db->block, hdr, sizeof(hdr));
+    Fifo_push(db->block, rec, sz);
+    if(Fifo_get_write_idx(db->block) >= DB_BLOCK_SZ)
+        return Database_flush_block(db);
+    return true;
+}
+
+bool Database_write_records(const Database_T db, const Fifo_T *recs, 
+                            size_t nr_recs)
+{
+    unsigned char hdr[DB_BATCH][DB_REC_HDR_SZ];
+    Database_Chunk iov[1 + 2 * DB_BATCH];
+    size_t i, n, sz;
+
+    if(!recs)
+        return false;
+/* Compressed: records are buffered in blocks anyway */
+    if(db->flags & DB_FLAG_LZ)
+    {
+        for(i = 0; i < nr_recs; i++)
+            if( !Database_write_record(db, Fifo_get_data(recs[i]), 
+                                       Fifo_get_write_idx(recs[i])) )
+                return false;
+        return true;
+    }
+
+/* Headers and records of a batch, gathered in one go */
+    while(nr_recs)
+    {
+        n = (nr_recs < DB_BATCH ? nr_recs : DB_BATCH);
+        for(i = 0; i < n; i++)
+        {
+            if( (sz = Fifo_get_write_idx(recs[i])) > UINT32_MAX )
+                return false;
+            Database_table_add(db, sz);
+            Database_put_u32(hdr[i], sz);
+            Database_put_u32(hdr[i] + 4, 
+                             crc32c(0, Fifo_get_data(recs[i]), sz));
+            iov[1 + 2 * i].iov_base = hdr[i];
+            iov[1 + 2 * i].iov_len = DB_REC_HDR_SZ;
+            iov[2 + 2 * i].iov_base = Fifo_get_data(recs[i]);
+            iov[2 + 2 * i].iov_len = sz;
+        }
+        if( !Database_put(db, iov, 1 + 2 * n) )
+            return false;
+        recs += n;
+        nr_recs -= n;
+    }
+    return true;
+}
+
+Fifo_T Database_read_record(const Database_T db)
+{
+    Fifo_T buf = Database_load(db), rec = NULL;
+    const unsigned char *hdr;
+    size_t sz;
+
+    if(!buf)
+        return NULL;
+
+/* Older versions: length prefix only */
+    if( Fifo_get_version(buf) < FIFO_VERSION_CRC )
+    {
+        if( !Fifo_pop_size(buf, &sz) )
+            return NULL;
+        return Fifo_slice(buf, sz);
+    }
+
+/* Header, record and its checksum: a torn record misses either */
+    if( !(hdr = Fifo_view(buf, DB_REC_HDR_SZ)) ||
+        !(rec = Fifo_slice(buf, Database_get_u32(hdr))) )
+        return NULL;
+    if( crc32c(0, Fifo_get_data(rec), Fifo_get_write_idx(rec)) != 
+        Database_get_u32(hdr + 4) )
+    {
+        Fifo_dtor(rec);
+        return NULL;
+    }
+    return rec;
+}
+
+size_t Database_get_count(const Database_T db)
+{
+    if( !Database_load(db) || !db->table )
+        return 0;
+    return Fifo_get_write_idx(db->table) / DB_TAB_ENTRY_SZ;
+}
+
+Fifo_T Database_read_nth(const Database_T db, size_t i)
+{
+    const unsigned char *ent, *hdr;
+    size_t sz, end;
+    uint64_t pos;
+    Fifo_T rec;
+
+    if( i >= Database_get_count(db) )
+        return NULL;
+    ent = (const unsigned char *)Fifo_get_data(db->table) + 
+          i * DB_TAB_ENTRY_SZ;
+    pos = db->recs_base + (Database_get_u32(ent) | 
+                           (uint64_t)Database_get_u32(ent + 4) << 32);
+    sz = Database_get_u32(ent + 8);
+    end = Fifo_get_write_idx(db->buf);
+/* The record, as the table says, and its checksum */
+    if(pos > end || end - pos < DB_REC_HDR_SZ + sz)
+        return NULL; // e.g., in a corrupted block
+    hdr = (const unsigned char *)Fifo_get_data(db->buf) + pos;
+    if( Database_get_u32(hdr) != sz || 
+        crc32c(0, hdr + DB_REC_HDR_SZ, sz) != Database_get_u32(hdr + 4) )
+        return NULL;
+    rec = Fifo_borrow(hdr + DB_REC_HDR_SZ, sz);
+    Fifo_set_version(rec, Fifo_get_version(db->buf));
+    return rec;
+}
+
+/**
+ * @brief Reads the header of a database file
+ * @param fp: file, at its start
+ * @param version: filled with the format version of its records
+ * @param flags: filled with its flags (DB_FLAG_*)
+ * @return true, if its records are framed (i.e., can be located); false, 
+ * otherwise
+ */
+static bool Database_read_header(FILE *fp, unsigned long long *version,
+                                 unsigned long long *flags)
+{
+    unsigned char hdr[DB_MAGIC_SZ + 2 * FIFO_VARINT_MAX];
+    size_t n = fread(hdr, 1, sizeof(hdr), fp);
+    Fifo_T fifo = Fifo_borrow(hdr, n);
+    bool ok;
+
+    *flags = 0;
+    ok = n >= DB_MAGIC_SZ && !memcmp(hdr, DB_MAGIC, DB_MAGIC_SZ) &&
+         Fifo_view(fifo, DB_MAGIC_SZ) && Fifo_pop_uvar(fifo, version) &&
+         *version >= FIFO_VERSION_CRC && *version <= FIFO_VERSION &&
+         (*version < FIFO_VERSION_FLAGS || Fifo_pop_uvar(fifo, flags));
+    Fifo_dtor(fifo);
+    return ok;
+}
+
+uint64_t Database_tell_record(const Database_T db)
+{
+/* Compressed: the pending block is written where the file ends */
+    if( (db->flags & DB_FLAG_LZ) && db->block )
+        return (uint64_t)db->size << DB_LOC_BITS | 
+               Fifo_get_write_idx(db->block);
+    return (uint64_t)db->size << DB_LOC_BITS;
+}
+
+Fifo_T Database_read_at(const Database_T db, uint64_t loc)
+{
+    unsigned char hdr[DB_BLK_HDR_SZ], *blk = NULL, *raw = NULL;
+    size_t pos = loc & ((1u << DB_LOC_BITS) - 1), len = 0, comp, sz;
+    long off = (long)(loc >> DB_LOC_BITS), end;
+    unsigned long long version, flags;
+    Fifo_T rec = NULL;
+    FILE *fp;
+
+    if( !(fp = fopen(db->name, "rb")) )
+        return NULL;
+/* Lengths are checked against the file: a stale locator reads garbage */
+    if( Database_read_header(fp, &version, &flags) && 
+        !fseek(fp, 0, SEEK_END) && (end = ftell(fp)) >= 0 && 
+        off <= end - DB_BLK_HDR_SZ && !fseek(fp, off, SEEK_SET) )
+    {
+        end -= off + DB_BLK_HDR_SZ;
+/* Compressed: the record is in the block there */
+        if( (flags & DB_FLAG_LZ) && 
+            fread(hdr, sizeof(hdr), 1, fp) == 1 )
+        {
+            len = Database_get_u32(hdr);
+            comp = Database_get_u32(hdr + 4);
+            if(comp > (size_t)end || len / 256 > comp)
+                comp = len = 0; // not a block
+            blk = malloc(comp ? comp : 1);
+            raw = (comp == len ? blk : malloc(len ? len : 1));
+            assert(blk && raw);
+            if( fread(blk, comp, 1, fp) != 1 || (raw != blk &&
+                LZ_decompress(blk, comp, raw, len) != len) )
+                len = 0;
+        }
+/* Otherwise, it is there */
+        else if( !(flags & DB_FLAG_LZ) && !pos && 
+                 fread(hdr, DB_REC_HDR_SZ, 1, fp) == 1 && 
+                 (len = Database_get_u32(hdr)) <= (size_t)end )
+        {
+            raw = blk = malloc(DB_REC_HDR_SZ + len);
+            assert(raw);
+            memcpy(raw, hdr, DB_REC_HDR_SZ);
+            len = (len && fread(raw + DB_REC_HDR_SZ, len, 1, fp) != 1) ? 
+                  0 : DB_REC_HDR_SZ + len;
+        }
+/* Header and checksum of the record, as loading would */
+        if( raw && pos + DB_REC_HDR_SZ <= len && 
+            (sz = Database_get_u32(raw + pos)) <= len - pos - DB_REC_HDR_SZ
+            && crc32c(0, raw + pos + DB_REC_HDR_SZ, sz) == 
+               Database_get_u32(raw + pos + 4) )
+        {
+            rec = Fifo_ctor(sz);
+            Fifo_push(rec, raw + pos + DB_REC_HDR_SZ, sz);
+            Fifo_set_version(rec, version);
+        }
+    }
+    if(raw != blk)
+        free(raw);
+    free(blk);
+    fclose(fp);
+    return rec;
+}
+
 size_t Database_get_size(const Database_T db)
 {
     return db->size;
 }
+
+/* ============================ Paged database ============================ */
+
+/**
+ * @brief Reads a page into the page buffer
+ * @param db: a valid, paged Database
+ * @param no: nr. of the page
+ * @return true, if successfull; false, otherwise (e.g., a torn page)
+ */
+static bool Database_page_read(const Database_T db, uint32_t no)
+{
+    if(!no || no >= db->nr_pages)
+        return false; // page 0 is the header, not a data page
+    if(no == db->page_no)
+        return true; // already there
+    db->page_no = 0;
+    if( fseek(db->fp, (long)no * DB_PAGE_SZ, SEEK_SET) ||
+        fread(db->page, DB_PAGE_SZ, 1, db->fp) != 1 ||
+        !Page_check(db->page, DB_PAGE_SZ) )
+        return false;
+    db->page_no = no;
+    return true;
+}
+
+/**
+ * @brief Writes the page buffer to its page, durably
+ * @param db: a valid, paged Database
+ * @return true, if successfull; false, otherwise
+ *
+ * The page is synced before returning, so the writes of an operation 
+ * reach the disk in the order they are made. @see Database_sync
+ */
+static bool Database_page_write(const Database_T db)
+{
+    Page_seal(db->page, DB_PAGE_SZ);
+    db->fsm[db->page_no] = Page_free(db->page) / DB_FSM_UNIT;
+    return !fseek(db->fp, (long)db->page_no * DB_PAGE_SZ, SEEK_SET) &&
+           fwrite(db->page, DB_PAGE_SZ, 1, db->fp) == 1 && 
+           Database_sync(db);
+}
+
+/**
+ * @brief Finds a page with room for a record, as per the free space map
+ * @param db: a valid, paged Database
+ * @param len: length of the record
+ * @param skip: page not to be chosen; 0 if none
+ * @return nr. of the page; if none has room, a new one is started in the 
+ * page buffer
+ */
+static uint32_t Database_page_find(const Database_T db, size_t len, 
+                                   uint32_t skip)
+{
+    unsigned char *fsm;
+    uint32_t no;
+
+/* Latest pages first: they are the likeliest to have room */
+    for(no = db->nr_pages - 1; no > 0; no--)
+        if(no != skip && (size_t)db->fsm[no] * DB_FSM_UNIT >= len)
+            return no;
+
+    fsm = realloc(db->fsm, db->nr_pages + 1);
+    assert(fsm);
+    db->fsm = fsm;
+    no = db->nr_pages++;
+    db->fsm[no] = 0;
+    Page_init(db->page, DB_PAGE_SZ);
+    db->page_no = no;
+    return no;
+}
+
+/**
+ * @brief Stores a record in a page with room for it
+ * @param db: a valid, paged Database
+ * @param rec: record
+ * @param sz: length of the record (up to DB_REC_MAX)
+ * @param flags: flags of the record (PAGE_FLAG_*)
+ * @param skip: page not to be chosen; 0 if none
+ * @param id: filled with the id of the record
+ * @return true, if successfull; false, otherwise
+ */
+static bool Database_place(const Database_T db, const void *rec, size_t sz,
+                           unsigned flags, uint32_t skip, uint32_t *id)
+{
+    uint32_t no = Database_page_find(db, sz, skip);
+    unsigned slot;
+
+    if( !Database_page_read(db, no) || (slot = Page_insert(db->page, 
+        DB_PAGE_SZ, rec, sz, flags)) == PAGE_NO_SLOT )
+        return false;
+    *id = DB_ID(no, slot);
+    return Database_page_write(db);
+}
+
+/**
+ * @brief Locates a record, following it if it was moved
+ * @param db: a valid, paged Database
+ * @param id: id of the record
+ * @param at: filled with the id of the record's data (*id*, unless moved)
+ * @param len: filled with the length of the record
+ * @return record, in the page buffer (its page is *at*'s); NULL if there is
+ * none
+ */
+static const void * Database_locate(const Database_T db, uint32_t id,
+                                    uint32_t *at, size_t *len)
+{
+    const unsigned char *rec;
+    unsigned flags;
+
+    if( !db->page || !Database_page_read(db, DB_ID_PAGE(id)) ||
+        !(rec = Page_get(db->page, DB_ID_SLOT(id), len, &flags)) ||
+        (flags & PAGE_FLAG_MOVED) )
+        return NULL; // moved records are reached from their home only
+    *at = id;
+    if( !(flags & PAGE_FLAG_FORWARD) )
+        return rec;
+
+/* Moved: its home holds the id of the data */
+    *at = Database_get_u32(rec);
+    if( !Database_page_read(db, DB_ID_PAGE(*at)) ||
+        !(rec = Page_get(db->page, DB_ID_SLOT(*at), len, &flags)) ||
+        !(flags & PAGE_FLAG_MOVED) )
+        return NULL;
+    return rec;
+}
+
+bool Database_open_paged(const Database_T db)
+{
+    unsigned char hdr[DB_PAGED_HDR_SZ];
+    uint32_t no;
+    long sz;
+
+    if(db->fp)
+        return (db->page != NULL); // already opened
+/* An existing paged file, or a new one */
+    if( (db->fp = fopen(db->name, "r+b")) )
+    {
+        if( fread(hdr, sizeof(hdr), 1, db->fp) != 1 || 
+            memcmp(hdr, DB_PAGED_MAGIC, DB_MAGIC_SZ) ||
+            Database_get_u32(hdr + 4) != DB_PAGED_VERSION ||
+            Database_get_u32(hdr + 8) != DB_PAGE_SZ ||
+            fseek(db->fp, 0, SEEK_END) || (sz = ftell(db->fp)) < 0 )
+        {
+            Database_close(db);
+            return false; // not a paged database
+        }
+        db->nr_pages = sz / DB_PAGE_SZ; // a torn last page is dropped
+    }
+    else if( (db->fp = fopen(db->name, "w+b")) )
+    {
+        db->page = calloc(1, DB_PAGE_SZ);
+        assert(db->page);
+        memcpy(db->page, DB_PAGED_MAGIC, DB_MAGIC_SZ);
+        Database_put_u32(db->page + 4, DB_PAGED_VERSION);
+        Database_put_u32(db->page + 8, DB_PAGE_SZ);
+        if( fwrite(db->page, DB_PAGE_SZ, 1, db->fp) != 1 || 
+            !Database_sync(db) )
+        {
+            Database_close(db);
+            return false;
+        }
+        db->nr_pages = 1;
+    }
+    else
+        return false;
+
+    if(!db->page)
+        db->page = malloc(DB_PAGE_SZ);
+    db->fsm = malloc(db->nr_pages);
+    assert(db->page && db->fsm);
+    db->page_no = 0;
+/* Free space map: from the pages' headers; torn pages are not used */
+    db->fsm[0] = 0;
+    for(no = 1; no < db->nr_pages; no++)
+        db->fsm[no] = Database_page_read(db, no) ? 
+                      Page_free(db->page) / DB_FSM_UNIT : 0;
+    return true;
+}
+
+bool Database_insert(const Database_T db, const void *rec, size_t sz,
+                     uint32_t *id)
+{
+    if(!db->page || !rec || sz > DB_REC_MAX)
+        return false;
+    return Database_place(db, rec, sz, 0, 0, id);
+}
+
+Fifo_T Database_read_id(const Database_T db, uint32_t id)
+{
+    const void *rec;
+    size_t len;
+    uint32_t at;
+    Fifo_T fifo;
+
+    if( !(rec = Database_locate(db, id, &at, &len)) )
+        return NULL;
+    fifo = Fifo_ctor(len);
+    Fifo_push(fifo, rec, len);
+    return fifo;
+}
+
+bool Database_write_id(const Database_T db, uint32_t id, const void *rec,
+                       size_t sz)
+{
+    unsigned char fwd[4];
+    uint32_t at, to;
+    size_t len;
+
+    if(!rec || sz > DB_REC_MAX || !Database_locate(db, id, &at, &len))
+        return false;
+/* In its page, if it fits: a single page write */
+    if( Page_update(db->page, DB_PAGE_SZ, DB_ID_SLOT(at), rec, sz, 
+                    at == id ? 0 : PAGE_FLAG_MOVED) )
+        return Database_page_write(db);
+
+/* Moved to another page first (synced), then its home refers to it: a 
+   crash in between leaves an unreachable copy, never a lost record */
+    if( !Database_place(db, rec, sz, PAGE_FLAG_MOVED, DB_ID_PAGE(at), &to) )
+        return false;
+    Database_put_u32(fwd, to);
+    if( !Database_page_read(db, DB_ID_PAGE(id)) ||
+        !Page_update(db->page, DB_PAGE_SZ, DB_ID_SLOT(id), fwd, sizeof(fwd),
+                     PAGE_FLAG_FORWARD) || !Database_page_write(db) )
+        return false;
+/* The former copy, if it had been moved already */
+    if(at != id)
+        return Database_page_read(db, DB_ID_PAGE(at)) &&
+               Page_delete(db->page, DB_ID_SLOT(at)) && 
+               Database_page_write(db);
+    return true;
+}
+
+bool Database_remove(const Database_T db, uint32_t id)
+{
+    uint32_t at;
+    size_t len;
+
+    if( !Database_locate(db, id, &at, &len) )
+        return false;
+/* Its home first: a moved copy is unreachable from then on */
+    if( !Database_page_read(db, DB_ID_PAGE(id)) ||
+        !Page_delete(db->page, DB_ID_SLOT(id)) || !Database_page_write(db) )
+        return false;
+    if(at != id)
+        return Database_page_read(db, DB_ID_PAGE(at)) &&
+               Page_delete(db->page, DB_ID_SLOT(at)) && 
+               Database_page_write(db);
+    return true;
+}
+
+Fifo_T Database_next(const Database_T db, uint32_t *id)
+{
+    uint32_t no = DB_ID_PAGE(*id + 1);
+    unsigned slot = DB_ID_SLOT(*id + 1), flags;
+    size_t len;
+    Fifo_T rec;
+
+    if(!db->page)
+        return NULL;
+    if(!no)
+    {
+        no = 1; // page 0 is the header
+        slot = 0;
+    }
+    for(; no < db->nr_pages; no++, slot = 0)
+        for(; Database_page_read(db, no) && 
+              slot < Page_nr_slots(db->page); slot++)
+        {
+/* Moved records are listed under their home's id */
+            if( !Page_get(db->page, slot, &len, &flags) ||
+                (flags & PAGE_FLAG_MOVED) )
+                continue;
+            if( (rec = Database_read_id(db, DB_ID(no, slot))) )
+            {
+                *id = DB_ID(no, slot);
+                return rec;
+            }
+        }
+    return NULL;
+}
@@ -4,6 +4,36 @@
  * @date 13 Jan 2019
  *
  * @brief Module that handles requests and writes to the the database
+ *
+ * Files created by the module start with a header: the magic "EGDB" and 
+ * the format version of the records (@see fifo.h), as a varint. Files 
+ * without it are from the legacy format.
+ * Since FIFO_VERSION_CRC, each record is framed by its length and its 
+ * CRC32C (both 32-bit, little-endian), so a torn or corrupted record is 
+ * detected on load. @see crc32c.h
+ * Since FIFO_VERSION_FLAGS, the version is followed by the file's flags, as
+ * a varint. With DB_FLAG_LZ, the framed records are grouped in blocks of 
+ * about DB_BLOCK_SZ bytes, compressed independently: the uncompressed and 
+ * the compressed length (32-bit each), then the block, which is stored as
+ * is if it does not shrink (both lengths equal). @see lz.h
+ * With DB_FLAG_TABLE, set on files written whole (@see Database_create), 
+ * the records are followed by an end mark (8 bytes of 0xff, an invalid 
+ * record or block header) and an offset table: per record, its offset in 
+ * the records as loaded (64-bit) and its length (32-bit); then a trailer:
+ * the offset of the table in the file (64-bit), the nr. of records, the 
+ * CRC32C of the table (32-bit each) and the magic "EGTB". Any record is 
+ * then found in O(1), without walking the ones before it.
+ *
+ * A *paged* Database (@see Database_open_paged) is another kind of file, 
+ * made of pages of DB_PAGE_SZ bytes: a header page (the magic "EGPG", the 
+ * version and the page size, 32-bit each), then slotted pages of records 
+ * (@see page.h). Each record is addressed by an id (its page and slot) that
+ * never changes, so it is read, updated or removed in place, usually with 
+ * a single page write. A record that outgrows its page is moved to 
+ * another one, and its home slot refers to it. Every page write is synced
+ * before the next one, so the copy is on disk before the reference to it.
+ * A free space map of every page, built on open, picks the page for new 
+ * records.
  */
 
 #ifndef DATABASE_H
@@ -11,6 +41,8 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include "fifo.h"
 
 /**
  * @brief opaque pointer to struct Database_T. 
@@ -18,6 +50,13 @@
  */
 typedef struct Database_T *Database_T;
 
+#define DB_FLAG_LZ 0x1 /**< File flag: records in compressed blocks */
+#define DB_FLAG_TABLE 0x2 /**< File flag: offset table after the records */
+#define DB_BLOCK_SZ (64 * 1024) /**< Uncompressed size of a block */
+#define DB_LOC_BITS 16 /**< Bits of a locator for the offset in its block */
+#define DB_PAGE_SZ 4096 /**< Size of a page of a paged Database */
+#define DB_REC_MAX (DB_PAGE_SZ - 14) /**< Max. record of a paged Database */
+
 /**
  * @brief Constructs a Database
  * @param name: name of the database (file)
@@ -36,21 +75,103 @@ void Database_dtor(Database_T db);
  * @param db: a valid Database
  * @param fmt: format to open the database
  * @return true, if successfull; false, otherwise;
+ *
+ * If opened for writing ("w" formats), the file is truncated and the header
+ * is written.
  */
 bool Database_open(const Database_T db, const char *fmt);
 
+/**
+ * @brief Enables or disables the compression of the Database
+ * @param db: a valid Database
+ * @param compressed: true, to write the records in compressed blocks
+ *
+ * Applies to files opened for writing afterwards; files are read as per
+ * their own flags.
+ */
+void Database_set_compressed(const Database_T db, bool compressed);
+
 /**
  * @brief Reopen a Database
  * @param db: a valid Database
  * @param fmt: format to reopen the database
  * @return true, if successfull; false, otherwise;
+ * @see Database_open
  */
 bool Database_reopen(const Database_T db, const char *fmt);
 
+/**
+ * @brief Creates a new version of the Database
+ * @param db: a valid Database
+ * @return true, if successfull; false, otherwise
+ *
+ * It is written to a temp file (the name of the Database and ".tmp"), 
+ * starting with the header, as Database_open in a "w" format would; the 
+ * Database itself is intact until the new version is committed. Closing 
+ * the Database before that abandons the new version. The records written
+ * are indexed by an offset table, written on commit.
+ * @see Database_commit
+ */
+bool Database_create(const Database_T db);
+
+/**
+ * @brief Makes everything written to the Database durable
+ * @param db: a valid, opened Database
+ * @return true, if successfull; false, otherwise
+ *
+ * The pending block and the writer's buffer are written and the file is 
+ * synced to the disk (fdatasync). It costs a disk flush, whatever was 
+ * written: sync after a batch of writes, not after each one.
+ */
+bool Database_sync(const Database_T db);
+
+/**
+ * @brief Commits the new version of the Database
+ * @param db: a valid Database, created by Database_create
+ * @return true, if successfull; false, otherwise (the new version is 
+ * abandoned)
+ *
+ * The new version is synced (@see Database_sync), closed and renamed over 
+ * the Database, atomically: a crash leaves either the old or the new 
+ * version, never a torn one. Mapped records of the old version remain 
+ * valid (@see Database_map).
+ */
+bool Database_commit(const Database_T db);
+
+/**
+ * @brief Sets the buffer of the Database's writer
+ * @param db: a valid Database
+ * @param buf: buffer, owned by the caller, that must outlive its use; NULL
+ * to write unbuffered
+ * @param sz: size of the buffer
+ * @return true, if the data pending in the former buffer was written (or 
+ * there was none); false, otherwise
+ *
+ * Appends (i.e., records and writes to SEEK_END) are coalesced in the 
+ * buffer, with no seeking, and written by a single writev once it is full,
+ * together with the data that did not fit. A larger buffer means fewer 
+ * system calls: a save as large as it takes one.
+ * @see Database_flush
+ */
+bool Database_set_buffer(const Database_T db, void *buf, size_t sz);
+
+/**
+ * @brief Writes the data pending in the Database's writer buffer
+ * @param db: a valid Database
+ * @return true, if successfull or nothing was pending; false, otherwise
+ *
+ * Unbuffered, it flushes the stdio buffer of the file instead. Either way,
+ * the data is handed to the system. Closing the Database flushes it as 
+ * well.
+ */
+bool Database_flush(const Database_T db);
+
 /**
  * @brief Close a Database
  * @param db: a valid Database
  * @return true, if successfull; false, otherwise;
+ *
+ * The pending block of a compressed Database is written first.
  */
 bool Database_close(const Database_T db);
 
@@ -81,6 +202,191 @@ bool Database_read(const Database_T db, void *elem, size_t sz, int origin);
 bool Database_write(const Database_T db, const void *elem, 
                     size_t sz, int origin);
 
+/**
+ * @brief Writes a record to the end of a Database opened for writing
+ * @param db: a valid, opened Database
+ * @param rec: serialized record
+ * @param sz: length of the record
+ * @return true, if successfull; false, otherwise
+ *
+ * The record is framed by its length and CRC32C. In a compressed 
+ * Database, it is buffered until its block is full or the Database is 
+ * closed.
+ * @see Database_set_buffer
+ */
+bool Database_write_record(const Database_T db, const void *rec, size_t sz);
+
+/**
+ * @brief Writes records to the end of a Database opened for writing
+ * @param db: a valid, opened Database
+ * @param recs: serialized records, one per FIFO (up to its write index)
+ * @param nr_recs: nr. of records
+ * @return true, if successfull; false, otherwise
+ *
+ * As Database_write_record, for each record; the records are gathered from
+ * the FIFOs by a writev per batch (or copied to the writer's buffer, if 
+ * they fit), with no intermediate copy.
+ */
+bool Database_write_records(const Database_T db, const Fifo_T *recs, 
+                            size_t nr_recs);
+
+/**
+ * @brief Reads the next record of the Database
+ * @param db: a valid Database
+ * @return FIFO with the record, to be destructed by the caller; NULL at 
+ * the end or at an invalid (torn or corrupted) record
+ *
+ * The Database is loaded if it was not yet (@see Database_load). The FIFO 
+ * borrows the record from the loaded buffer (@see Fifo_slice), and its 
+ * CRC32C is checked before it is returned. Loading should stop at the first
+ * NULL: the records after an invalid one cannot be trusted.
+ */
+Fifo_T Database_read_record(const Database_T db);
+
+/**
+ * @brief Gets the nr. of records of the Database, from its offset table
+ * @param db: a valid Database
+ * @return nr. of records; 0 if it has no (valid) offset table
+ *
+ * The Database is loaded if it was not yet (@see Database_load).
+ */
+size_t Database_get_count(const Database_T db);
+
+/**
+ * @brief Reads a record of the Database by its index
+ * @param db: a valid Database
+ * @param i: index of the record (from 0)
+ * @return FIFO with the record, to be destructed by the caller; NULL if 
+ * there is none or it is invalid
+ *
+ * As Database_read_record, but in O(1), by the offset table: records can
+ * be read in any order, each one on its own (e.g., split among workers).
+ * @see Database_get_count
+ */
+Fifo_T Database_read_nth(const Database_T db, size_t i);
+
+/**
+ * @brief Gets the locator of the next record written to the Database
+ * @param db: a valid Database, created anew (@see Database_create)
+ * @return locator: the offset of the record, or of its compressed block, 
+ * in the file, shifted by DB_LOC_BITS; then its offset in the block
+ *
+ * Locators remain valid until the Database is written anew.
+ * @see Database_read_at
+ */
+uint64_t Database_tell_record(const Database_T db);
+
+/**
+ * @brief Reads a single record of the Database
+ * @param db: a valid Database
+ * @param loc: locator of the record (@see Database_tell_record)
+ * @return FIFO with the record, to be destructed by the caller; NULL if 
+ * there is none (or it is invalid)
+ *
+ * Random access: the file is not loaded, only the record is read (with its
+ * block, if compressed), and its CRC32C checked. Legacy files, whose 
+ * records are not framed, cannot be read this way.
+ */
+Fifo_T Database_read_at(const Database_T db, uint64_t loc);
+
+/**
+ * @brief Maps the whole database into memory (read-only)
+ * @param db: a valid Database
+ * @return FIFO with the records of the database; NULL if it does not exist,
+ * cannot be mapped or its format version is unknown
+ *
+ * Like Database_load, but the FIFO reads straight from a read-only mapping 
+ * of the file (advised as sequential): no copying and no system call per
+ * record. The mapping lives until the Database is destructed; a file 
+ * opened for writing ("w" formats) meanwhile is created anew, so the 
+ * mapped one remains intact. Compressed files are decompressed and 
+ * unmapped at once.
+ */
+Fifo_T Database_map(const Database_T db);
+
+/**
+ * @brief Loads the whole database into memory
+ * @param db: a valid Database
+ * @return FIFO with the records of the database; NULL if it does not exist
+ * or its format version is unknown (i.e., newer)
+ *
+ * The file is mapped if possible (@see Database_map), or read at once 
+ * otherwise; later calls return the same FIFO, whose read 
+ * index tracks the records consumed so far. The FIFO is owned by the 
+ * Database and lives until it is destructed, so the records deserialized 
+ * from it may borrow data from its buffer.
+ * The header is consumed and the FIFO's version set from it; compressed 
+ * blocks are decompressed into the FIFO (up to the first invalid one).
+ * @see fifo.h
+ */
+Fifo_T Database_load(const Database_T db);
+
+/**
+ * @brief Opens a paged Database, creating it if it does not exist
+ * @param db: a valid Database
+ * @return true, if successfull; false, otherwise (e.g., not a paged file)
+ *
+ * Records are then accessed by id, with the functions below; 
+ * Database_close closes it.
+ */
+bool Database_open_paged(const Database_T db);
+
+/**
+ * @brief Inserts a record in a paged Database
+ * @param db: a valid, paged Database
+ * @param rec: serialized record
+ * @param sz: length of the record (up to DB_REC_MAX)
+ * @param id: filled with the id of the record
+ * @return true, if successfull; false, otherwise
+ */
+bool Database_insert(const Database_T db, const void *rec, size_t sz,
+                     uint32_t *id);
+
+/**
+ * @brief Reads a record of a paged Database
+ * @param db: a valid, paged Database
+ * @param id: id of the record
+ * @return FIFO with the record, to be destructed by the caller; NULL if 
+ * there is none (or its page is torn)
+ */
+Fifo_T Database_read_id(const Database_T db, uint32_t id);
+
+/**
+ * @brief Updates a record of a paged Database
+ * @param db: a valid, paged Database
+ * @param id: id of the record
+ * @param rec: new serialized record
+ * @param sz: length of the new record (up to DB_REC_MAX)
+ * @return true, if successfull; false, otherwise
+ *
+ * A single page write, if it fits in its page; otherwise, it is moved and 
+ * keeps its id.
+ */
+bool Database_write_id(const Database_T db, uint32_t id, const void *rec,
+                       size_t sz);
+
+/**
+ * @brief Removes a record of a paged Database
+ * @param db: a valid, paged Database
+ * @param id: id of the record
+ * @return true, if successfull; false, otherwise
+ *
+ * Its id may be reused by a record inserted afterwards.
+ */
+bool Database_remove(const Database_T db, uint32_t id);
+
+/**
+ * @brief Reads the record that follows an id in a paged Database
+ * @param db: a valid, paged Database
+ * @param id: id to start after (0 to start at the first record); filled 
+ * with the id of the record read
+ * @return FIFO with the record, to be destructed by the caller; NULL at the
+ * end
+ *
+ * Walks every record, in order of id.
+ */
+Fifo_T Database_next(const Database_T db, uint32_t *id);
+
 /**
  * @brief Get size of the database
  * @return size of the database
@@ -7,6 +7,7 @@
  */
 
 #include "Pack.h"
+#include "schema.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -14,7 +15,6 @@
 
 #define DEBUG /**< For debugging throughout the code */
 
-#define PACK_FIFO_SZ 64 /**< FIFO's size is unknown; define a sufficiently larger one */
 
 /**
  * @brief Pack's structure: contains the relevant data members
@@ -24,6 +24,7 @@ struct Pack_T
     char *nome; /**< name */
     int duracao; /**< duration (in months) */
     double custo; /**< cost [€] */
+    bool borrowed; /**< true, if nome is borrowed from a load buffer */
 };
 
 /**
@@ -53,11 +54,27 @@ static Pack_T pack_new()
 	return pack;
 }
 
+/**
+ * @brief Makes the Pack own its name
+ * @param pack: a constructed Pack
+ *
+ * Packs loaded from the database borrow their name from the load buffer
+ * (@see pack_deserialize); it is copied before being modified.
+ */
+static void pack_own(Pack_T pack)
+{
+    if(!pack->borrowed)
+        return;
+    pack->nome = str_dup(pack->nome);
+    pack->borrowed = false;
+}
+
 Pack_T pack_ctor()
 {
    Pack_T pack = pack_new();
    /* Construct pack */
    pack->nome = NULL;
+   pack->borrowed = false;
    pack->duracao = 1; // minimum duration
    pack->custo = 5.0; // minimum cost
 
@@ -66,7 +83,8 @@ Pack_T pack_ctor()
 
 void pack_dtor(Pack_T pack)
 {
-    free(pack->nome);
+    if(!pack->borrowed)
+        free(pack->nome);
     free(pack);
 }
 
@@ -76,10 +94,11 @@ bool pack_clone(const Pack_T pack, Pack_T clone)
         return false;
 
    /* Copy info to clone from pack */
+   pack_own(clone);
    if(pack->nome)
    {
-       clone->nome = malloc(strlen(pack->nome) + 1);
-       strcpy(clone->nome, pack->nome);
+       free(clone->nome);
+       clone->nome = str_dup(pack->nome);
    }
    clone->duracao = pack->duracao;
    clone->custo = pack->custo;
@@ -150,6 +169,7 @@ int pack_set_name(Pack_T pack)
             return B_FALSE; // invalid
     } while (!validateString(input));
 
+    pack_own(pack); // modifying: stop borrowing
 
     // allocate dinamic memory for string
     if( !pack->nome )
@@ -249,47 +269,50 @@ int pack_cmp_name(const Pack_T pack1, const Pack_T pack2)
     return strcmp(pack1->nome, pack2->nome);
 }
 
+/**
+ * @brief Serialized fields of the Pack, in order (@see schema.h)
+ */
+#define PACK_SCHEMA(X) \
+    X(STR, nome)       \
+    X(INT, duracao)    \
+    X(REAL, custo)
+
+SCHEMA_DEFINE(pack, Pack_T, PACK_SCHEMA)
+
 Fifo_T pack_serialize(Pack_T pack)
 {
     if(!pack)
         return NULL;
 
-    size_t sz = strlen(pack->nome) + 1 
-        + sizeof(pack->duracao) + sizeof(pack->custo);
- 
-    Fifo_T fifo = Fifo_ctor(sz);
-    //Fifo_push(fifo, &sz, sizeof(sz));
-
-/* Nome */
-    sz = strlen(pack->nome) + 1;
-    Fifo_push(fifo, &sz, sizeof(sz));
-    Fifo_push(fifo, pack->nome, sz);
-/* duracao */
-    Fifo_push(fifo, &(pack->duracao), sizeof(pack->duracao));
-/* custo */
-    Fifo_push(fifo, &(pack->custo), sizeof(pack->custo));
-
+    Fifo_T fifo = Fifo_ctor(pack_schema_size(pack));
+    pack_schema_encode(pack, fifo);
     return fifo;
 }
 
+size_t pack_serialize_into(const Pack_T pack, Fifo_T fifo)
+{
+    if(!pack || !fifo)
+        return 0;
+
+    pack_schema_encode(pack, fifo);
+    return Fifo_get_write_idx(fifo);
+}
+
 Pack_T pack_deserialize(Fifo_T fifo)
 {
     if(!fifo)
         return NULL;
-    size_t sz = 0;
 
     /* Construct a pack */
     Pack_T pack = pack_ctor();
-/* Retrieve size of nome */
-    Fifo_pop(fifo, &sz, sizeof(sz));
-/* Initialize nome */
-    pack->nome = malloc(sz);
-    assert(pack->nome);
-    Fifo_pop(fifo, pack->nome, sz);
-/* Initialize duracao */
-    Fifo_pop(fifo, &(pack->duracao), sizeof(pack->duracao));
-/* Initialize custo */
-    Fifo_pop(fifo, &(pack->custo), sizeof(pack->custo));
+
+/* Decode the fields; nome is borrowed from the buffer (no copy) */
+    pack->borrowed = true;
+    if( !pack_schema_decode(pack, fifo) )
+    {
+        pack_dtor(pack);
+        return NULL;
+    }
 
     return pack;
 }
@@ -173,6 +173,26 @@ int pack_cmp_name(const Pack_T pack1,const Pack_T pack2);
  */
 Fifo_T pack_serialize(Pack_T pack);
 
+/**
+ * @brief Serializes Pack attributes, appending them to a FIFO
+ * @param pack: a constructed Pack
+ * @param fifo: a valid FIFO; it grows as needed
+ * @return the FIFO's write index after the Pack; 0 in error
+ *
+ * Lets the caller reuse one FIFO for many records (@see Fifo_reset).
+ * @see fifo.h
+ */
+size_t pack_serialize_into(const Pack_T pack, Fifo_T fifo);
+
+/**
+ * @brief Prints every serialized field of the Pack, one per line
+ * @param pack: a constructed Pack
+ *
+ * Used for debugging; generated from the Pack's schema.
+ * @see schema.h
+ */
+void pack_print_fields(const Pack_T pack);
+
 /**
  * @brief Deserializes Pack attributes into a FIFO
  * @param fifo: FIFO buffer containing the serialized Pack
@@ -11,15 +11,15 @@
 #include <string.h>
 #include <assert.h>
 #include "User.h"
+#include "schema.h"
 #include "Activity.h"
 #include "Pack.h"
 #include "list.h"
+#include "hash.h"
 #include "m-utils.h"
 
 #define DEBUG /**< For debugging throughout the code */
 
-#define USER_FIFO_SZ 1024 /**< FIFO's size is unknown; define a sufficiently larger one */
-
 /**
  * @brief User's structure: contains the relevant data members
  */
@@ -37,6 +37,7 @@ struct User_T // Atomic
     enum User_type tipo; /**< type: @see User_type */
     Pack_T pack; /**< single Pack for User */
     List_T activities; /**< list of activities the user is signed in */
+    bool borrowed; /**< true, if the strings are borrowed from a load buffer */
 };
 
 /**
@@ -106,6 +107,23 @@ static User_T user_new()
    return user;
 }
 
+/**
+ * @brief Makes the User own its strings
+ * @param user: a constructed User
+ *
+ * Users loaded from the database borrow their strings from the load buffer
+ * (@see user_deserialize); they are copied before being modified.
+ */
+static void user_own(User_T user)
+{
+    if(!user->borrowed)
+        return;
+    user->username = str_dup(user->username);
+    user->pass = str_dup(user->pass);
+    user->nome = str_dup(user->nome);
+    user->borrowed = false;
+}
+
 User_T user_ctor(enum User_type tipo)
 {
    User_T user = user_new();
@@ -114,6 +132,7 @@ User_T user_ctor(enum User_type tipo)
    user->username = NULL;
    user->pass = NULL;
    user->nome = NULL;
+   user->borrowed = false;
    user->idade = 18;
    user->sexo = 0;
    user->altura = 1.5;
@@ -142,9 +161,12 @@ void user_dtor(User_T user)
 #endif
 
     /* Release dynamically allocated memory first */
-    free(user->nome);
-    free(user->pass);
-    free(user->username);
+    if(!user->borrowed)
+    {
+        free(user->nome);
+        free(user->pass);
+        free(user->username);
+    }
 
     /* Release user */
     free(user);
@@ -159,20 +181,21 @@ bool user_clone(const User_T user, User_T clone)
         return false;
 
    /* Copy info to clone from user */
+   user_own(clone);
    if(user->nome)
    {
-       clone->nome = malloc(strlen(user->nome) + 1);
-       strcpy(clone->nome, user->nome);
+       free(clone->nome);
+       clone->nome = str_dup(user->nome);
    }
    if(user->pass)
    {
-       clone->pass = malloc(strlen(user->pass) + 1);
-       strcpy(clone->pass, user->pass);
+       free(clone->pass);
+       clone->pass = str_dup(user->pass);
    }
    if(user->username)
    {
-       clone->username = malloc(strlen(user->username) + 1);
-       strcpy(clone->username, user->username);
+       free(clone->username);
+       clone->username = str_dup(user->username);
    }
 
    clone->idade = user->idade;
@@ -267,6 +290,11 @@ int user_cmp_type(const User_T user1, const User_T user2)
     return (user1->tipo - user2->tipo);
 }
 
+unsigned user_hash_username(const User_T user)
+{
+    return Hash_string_nocase(user->username);
+}
+
 int user_set_username(User_T user)
 {
     if(!user) // invalid user
@@ -282,6 +310,8 @@ int user_set_username(User_T user)
             return B_FALSE; // invalid
     } while (!validateString(input));
 
+    user_own(user); // modifying: stop borrowing
+
     // allocate dinamic memory for string
     if( !user->username )
     {
@@ -328,6 +358,8 @@ int user_set_name(User_T user)
     } while (!validateString(input));
 
 
+    user_own(user); // modifying: stop borrowing
+
     // allocate dinamic memory for string
     if( !user->nome )
         user->nome = malloc( strlen(input) + 1 );
@@ -356,6 +388,8 @@ int user_set_pass(User_T user)
             return B_FALSE; // invalid
     } while (!validateString(input));
 
+    user_own(user); // modifying: stop borrowing
+
     // allocate dinamic memory for string
     if( !user->pass )
         user->pass = malloc( strlen(input) + 1 );
@@ -492,6 +526,11 @@ enum User_type user_get_type(const User_T user)
     return user->tipo;
 }
 
+const char * user_get_username(const User_T user)
+{
+    return user->username;
+}
+
 const char * user_get_pass(const User_T user)
 {
     return user->pass;
@@ -600,129 +639,61 @@ List_T user_get_activities(const User_T user)
     return user->activities;
 }
 
+/**
+ * @brief Serialized fields of the User, in order (@see schema.h)
+ *
+ * The pack and the activities are relations to other objects, not 
+ * attributes: they are not serialized; BMI is computed from the fields.
+ */
+#define USER_SCHEMA(X) \
+    X(STR, username)   \
+    X(STR, pass)       \
+    X(STR, nome)       \
+    X(INT, idade)      \
+    X(CHAR, sexo)      \
+    X(REAL, altura)    \
+    X(REAL, peso)      \
+    X(REAL, saldo)     \
+    X(UINT, tipo)
+
+SCHEMA_DEFINE(user, User_T, USER_SCHEMA)
+
 Fifo_T user_serialize(User_T user)
 {
     if(!user)
         return NULL;
 
-/* Unknown size -> fix a sufficiently large buffer */
-    size_t sz = USER_FIFO_SZ;
- 
-    Fifo_T fifo = Fifo_ctor(sz);
-//    Fifo_T fifo_pack = NULL;
-    //Fifo_push(fifo, &sz, sizeof(sz));
-//    char *username; // rw (unique)
-//    char *pass; // rw
-//    char *nome; // rw
-//    int idade; // rw
-//    char sexo; // rw
-//    float altura; // rw
-//    float peso; // rw
-//    float bmi; // read
-//    float saldo; // read
-//    enum User_type tipo; // read
-//    Pack_T pack; // single pack for user
-//    List_T activities; // activities the user signed in
-
-/* username */
-    sz = strlen(user->username) + 1;
-    Fifo_push(fifo, &sz, sizeof(sz));
-    Fifo_push(fifo, user->username, sz);
-/* pass */
-    sz = strlen(user->pass) + 1;
-    Fifo_push(fifo, &sz, sizeof(sz));
-    Fifo_push(fifo, user->pass, sz);
-/* Nome */
-    sz = strlen(user->nome) + 1;
-    Fifo_push(fifo, &sz, sizeof(sz));
-    Fifo_push(fifo, user->nome, sz);
-/* idade */
-    Fifo_push(fifo, &(user->idade), sizeof(user->idade));
-/* sexo */
-    Fifo_push(fifo, &(user->sexo), sizeof(user->sexo));
-/* altura */
-    Fifo_push(fifo, &(user->altura), sizeof(user->altura));
-/* peso */
-    Fifo_push(fifo, &(user->peso), sizeof(user->peso));
-/* saldo */
-    Fifo_push(fifo, &(user->saldo), sizeof(user->saldo));
-/* tipo */
-    Fifo_push(fifo, &(user->tipo), sizeof(user->tipo));
-/* Pack */
-//    sz = 0;
-//    if(user->pack)
-//    {
-//        /* Push TAG */
-//        sz = PACK_TAG;
-//        Fifo_push(fifo, &sz, sizeof(sz));
-//        /* Serialize pack */
-//        fifo_pack = pack_serialize(user->pack);
-//        sz = Fifo_get_size(fifo_pack);
-//        /* Write size of pack first */
-////    Fifo_push(fifo, &sz, sizeof(sz));
-//        /* Push pack */
-//        Fifo_push(fifo, fifo_pack, sz);
-//        /* Destroy fifo_pack (no longer required) */
-//        Fifo_dtor(fifo_pack);
-//    }
-//    else  /* Push 0 */
-//        Fifo_push(fifo, &sz, sizeof(sz));
-
-/* Reset size to actual size (write position) */
-    Fifo_set_size(fifo, Fifo_get_write_idx(fifo));
-
+    Fifo_T fifo = Fifo_ctor(user_schema_size(user));
+    user_schema_encode(user, fifo);
     return fifo;
 }
 
+size_t user_serialize_into(const User_T user, Fifo_T fifo)
+{
+    if(!user || !fifo)
+        return 0;
+
+    user_schema_encode(user, fifo);
+    return Fifo_get_write_idx(fifo);
+}
+
 User_T user_deserialize(Fifo_T fifo)
 {
     if(!fifo)
         return NULL;
-    size_t sz = 0;
 
     /* Construct a user (type will be corrected later on)*/
     User_T user = user_ctor(Cliente);
 
-/* Retrieve size of username */
-    Fifo_pop(fifo, &sz, sizeof(sz));
-/* Initialize username */
-    user->username = malloc(sz);
-    assert(user->username);
-    Fifo_pop(fifo, user->username, sz);
-/* Retrieve size of pass */
-    Fifo_pop(fifo, &sz, sizeof(sz));
-/* Initialize pass */
-    user->pass = malloc(sz);
-    assert(user->pass);
-    Fifo_pop(fifo, user->pass, sz);
-/* Retrieve size of nome */
-    Fifo_pop(fifo, &sz, sizeof(sz));
-/* Initialize nome */
-    user->nome = malloc(sz);
-    assert(user->nome);
-    Fifo_pop(fifo, user->nome, sz);
-/* idade */
-    Fifo_pop(fifo, &(user->idade), sizeof(user->idade));
-/* sexo */
-    Fifo_pop(fifo, &(user->sexo), sizeof(user->sexo));
-/* altura */
-    Fifo_pop(fifo, &(user->altura), sizeof(user->altura));
-/* peso */
-    Fifo_pop(fifo, &(user->peso), sizeof(user->peso));
-/* saldo */
-    Fifo_pop(fifo, &(user->saldo), sizeof(user->saldo));
-/* tipo */
-    Fifo_pop(fifo, &(user->tipo), sizeof(user->tipo));
+/* Decode the fields; strings are borrowed from the buffer (no copies) */
+    user->borrowed = true;
+    if( !user_schema_decode(user, fifo) || user->tipo > Cliente )
+    {
+        user_dtor(user);
+        return NULL;
+    }
 /* BMI can be calculated */
     user_calc_bmi(user);
-/* Pack */
-    /* Check for pack */
-//    Fifo_pop(fifo, &sz, sizeof(sz));
-//    if(sz == PACK_TAG) /* Deserialize pack */
-//        user->pack = pack_deserialize(fifo);
-    //fifo_pack = Fifo_ctor(sz);
-    /* Destroy fifo_pack (no longer required) */
-//    Fifo_dtor(fifo_pack);
 
     return user;
 }
@@ -178,6 +178,13 @@ int user_pay(User_T user, float amount);
  */
 enum User_type user_get_type(const User_T user);
 
+/**
+ * @brief Gets the User's username
+ * @param user: a constructed User
+ * @return User's username
+ */
+const char * user_get_username(const User_T user);
+
 /**
  * @brief Gets the User's password
  * @param user: a constructed User
@@ -274,6 +281,16 @@ int user_cmp_username(const User_T user1, const User_T user2);
  * perform sorted insertion and sorting.
  */
 int user_cmp_type(const User_T user1, const User_T user2);
+
+/**
+ * @brief Hashes a user by username
+ * @param user: a constructed User
+ * @return hash value of the *username* attribute
+ *
+ * Case insensitive, consistent with user_cmp_username.
+ * @see hash.h: *Hash* functions are required by *Hash* to index users.
+ */
+unsigned user_hash_username(const User_T user);
 /* ------------------------------------------------------------------- */
 
 /*-------------------------- List related ---------------------------- */
@@ -321,6 +338,26 @@ void user_list_activities(const User_T user);
  */
 Fifo_T user_serialize(User_T user);
 
+/**
+ * @brief Serializes User attributes, appending them to a FIFO
+ * @param user: a constructed User
+ * @param fifo: a valid FIFO; it grows as needed
+ * @return the FIFO's write index after the User; 0 in error
+ *
+ * Lets the caller reuse one FIFO for many records (@see Fifo_reset).
+ * @see fifo.h
+ */
+size_t user_serialize_into(const User_T user, Fifo_T fifo);
+
+/**
+ * @brief Prints every serialized field of the User, one per line
+ * @param user: a constructed User
+ *
+ * Used for debugging; generated from the User's schema.
+ * @see schema.h
+ */
+void user_print_fields(const User_T user);
+
 /**
  * @brief Deserializes User attributes into a FIFO
  * @param fifo: FIFO buffer containing the serialized User
@@ -0,0 +1,640 @@
+/**
+ * @file btree.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief btree's module implementation
+ */
+
+#include "btree.h"
+#include "crc32c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h> // memcpy, memmove, memcmp, memset
+#include <assert.h>
+
+/* Node fields: offsets */
+#define BT_CRC 0 /**< CRC32C of the rest of the node (32-bit) */
+#define BT_LEAF 4 /**< Leaf (1) or inner node (0) */
+#define BT_NR 6 /**< Nr. of entries */
+#define BT_CHILD0 8 /**< Inner node: child of the keys below the first key */
+#define BT_ENTRIES 12 /**< Entries: key and value (or child) */
+
+/* Meta page fields: offsets */
+#define BT_MAGIC 4 /**< Magic */
+#define BT_VERSION 8 /**< Format version */
+#define BT_PAGE_SZ 12 /**< Page size */
+#define BT_ROOT 16 /**< Page of the root; 0 if empty */
+#define BT_HEIGHT 20 /**< Nr. of levels */
+#define BT_NR_PAGES 24 /**< Nr. of pages, the meta page's included */
+
+#define BTREE_MAGIC "EGBT" /**< First bytes of a B+tree file */
+#define BTREE_VERSION 1 /**< Format version */
+#define BTREE_ENTRY_SZ (BTREE_KEY_SZ + 8) /**< Size of an entry */
+/** Max. nr. of entries of a node */
+#define BTREE_CAP ((BTREE_PAGE_SZ - BT_ENTRIES) / BTREE_ENTRY_SZ)
+#define BTREE_MAX_DEPTH 16 /**< Max. nr. of levels */
+#define BTREE_TMP_EXT ".tmp" /**< Extension of the temp file of a rebuild */
+
+typedef unsigned char byte; /**< atomic unit of data */
+
+/**
+ * @brief B+tree's structure
+ */
+struct BTree_T{
+    char *name; /**< name of the file */
+    FILE *fp; /**< file */
+    uint32_t root; /**< page of the root; 0 if empty */
+    uint32_t height; /**< nr. of levels */
+    uint32_t nr_pages; /**< nr. of pages, the meta page's included */
+    byte *node; /**< node buffer (room for an extra entry, before a split) */
+    byte *split; /**< buffer of the upper half of a split node */
+    char *tmp; /**< rebuild: temp file; NULL if not rebuilding */
+    FILE *load_fp; /**< rebuild: temp file */
+    uint32_t load_pages; /**< rebuild: nr. of pages written */
+    unsigned long load_n; /**< rebuild: nr. of entries added */
+    unsigned nr_levels; /**< rebuild: nr. of levels so far */
+    byte *load[BTREE_MAX_DEPTH]; /**< rebuild: node being filled per level */
+    bool load_empty[BTREE_MAX_DEPTH]; /**< rebuild: node with no entries */
+    byte low[BTREE_MAX_DEPTH][BTREE_KEY_SZ]; /**< rebuild: lowest key of the
+    node being filled per level */
+    byte last[BTREE_KEY_SZ]; /**< rebuild: last key added */
+};
+
+/**
+ * @brief Loads a 16-bit value stored in little-endian order
+ * @param p: source (2 bytes)
+ * @return value
+ */
+static unsigned BTree_get16(const byte *p)
+{
+    return p[0] | (unsigned)p[1] << 8;
+}
+
+/**
+ * @brief Stores a 16-bit value in little-endian order
+ * @param p: destination (2 bytes)
+ * @param val: value to store
+ */
+static void BTree_put16(byte *p, unsigned val)
+{
+    p[0] = val;
+    p[1] = val >> 8;
+}
+
+/**
+ * @brief Loads a 32-bit value stored in little-endian order
+ * @param p: source (4 bytes)
+ * @return value
+ */
+static uint32_t BTree_get32(const byte *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+           (uint32_t)p[3] << 24;
+}
+
+/**
+ * @brief Stores a 32-bit value in little-endian order
+ * @param p: destination (4 bytes)
+ * @param val: value to store
+ */
+static void BTree_put32(byte *p, uint32_t val)
+{
+    BTree_put16(p, val & 0xffff);
+    BTree_put16(p + 2, val >> 16);
+}
+
+/**
+ * @brief Loads a 64-bit value stored in little-endian order
+ * @param p: source (8 bytes)
+ * @return value
+ */
+static uint64_t BTree_get64(const byte *p)
+{
+    return BTree_get32(p) | (uint64_t)BTree_get32(p + 4) << 32;
+}
+
+/**
+ * @brief Stores a 64-bit value in little-endian order
+ * @param p: destination (8 bytes)
+ * @param val: value to store
+ */
+static void BTree_put64(byte *p, uint64_t val)
+{
+    BTree_put32(p, (uint32_t)val);
+    BTree_put32(p + 4, (uint32_t)(val >> 32));
+}
+
+/**
+ * @brief Pads a key with zeros, as stored
+ * @param key: key
+ * @param k: filled with the padded key (BTREE_KEY_SZ bytes)
+ * @return true, if successfull; false, if the key is too long
+ */
+static bool BTree_pad(const char *key, byte *k)
+{
+    size_t len;
+
+    if(!key || (len = strlen(key)) >= BTREE_KEY_SZ)
+        return false;
+    memset(k, 0, BTREE_KEY_SZ);
+    memcpy(k, key, len);
+    return true;
+}
+
+/**
+ * @brief Gets an entry of a node
+ * @param node: node
+ * @param i: index of the entry
+ * @return entry: key, then value
+ */
+static byte * BTree_entry(const byte *node, unsigned i)
+{
+    return (byte *)node + BT_ENTRIES + i * BTREE_ENTRY_SZ;
+}
+
+/**
+ * @brief Gets the nr. of entries of a node
+ * @param node: node
+ * @return nr. of entries
+ */
+static unsigned BTree_nr(const byte *node)
+{
+    return BTree_get16(node + BT_NR);
+}
+
+/**
+ * @brief Searches a key in a node
+ * @param node: node
+ * @param k: padded key
+ * @param found: filled with true, if the key is there; false, otherwise
+ * @return index of the first entry not below the key
+ */
+static unsigned BTree_search(const byte *node, const byte *k, bool *found)
+{
+    unsigned lo = 0, hi = BTree_nr(node), mid;
+
+    while(lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if(memcmp(BTree_entry(node, mid), k, BTREE_KEY_SZ) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    *found = (lo < BTree_nr(node) &&
+              !memcmp(BTree_entry(node, lo), k, BTREE_KEY_SZ));
+    return lo;
+}
+
+/**
+ * @brief Inserts an entry in a node
+ * @param node: node, with room for it
+ * @param i: index of the entry
+ * @param k: padded key
+ * @param val: value (or child)
+ */
+static void BTree_insert_at(byte *node, unsigned i, const byte *k,
+                            uint64_t val)
+{
+    unsigned n = BTree_nr(node);
+
+    memmove(BTree_entry(node, i + 1), BTree_entry(node, i),
+            (n - i) * BTREE_ENTRY_SZ);
+    memcpy(BTree_entry(node, i), k, BTREE_KEY_SZ);
+    BTree_put64(BTree_entry(node, i) + BTREE_KEY_SZ, val);
+    BTree_put16(node + BT_NR, n + 1);
+}
+
+/**
+ * @brief Reads a node
+ * @param fp: file
+ * @param no: page of the node
+ * @param node: filled with the node
+ * @return true, if successfull; false, otherwise (e.g., a torn node)
+ */
+static bool BTree_read(FILE *fp, uint32_t no, byte *node)
+{
+    return no && !fseek(fp, (long)no * BTREE_PAGE_SZ, SEEK_SET) &&
+           fread(node, BTREE_PAGE_SZ, 1, fp) == 1 &&
+           BTree_get32(node + BT_CRC) == crc32c(0, node + 4,
+                                                BTREE_PAGE_SZ - 4) &&
+           BTree_nr(node) <= BTREE_CAP;
+}
+
+/**
+ * @brief Writes a node, stamping its checksum
+ * @param fp: file
+ * @param no: page of the node
+ * @param node: node
+ * @return true, if successfull; false, otherwise
+ */
+static bool BTree_write(FILE *fp, uint32_t no, byte *node)
+{
+    BTree_put32(node + BT_CRC, crc32c(0, node + 4, BTREE_PAGE_SZ - 4));
+    return !fseek(fp, (long)no * BTREE_PAGE_SZ, SEEK_SET) &&
+           fwrite(node, BTREE_PAGE_SZ, 1, fp) == 1;
+}
+
+/**
+ * @brief Writes the meta page
+ * @param fp: file
+ * @param root: page of the root
+ * @param height: nr. of levels
+ * @param nr_pages: nr. of pages
+ * @return true, if successfull; false, otherwise
+ */
+static bool BTree_write_meta(FILE *fp, uint32_t root, uint32_t height,
+                             uint32_t nr_pages)
+{
+    byte meta[BTREE_PAGE_SZ] = {0};
+
+    memcpy(meta + BT_MAGIC, BTREE_MAGIC, 4);
+    BTree_put32(meta + BT_VERSION, BTREE_VERSION);
+    BTree_put32(meta + BT_PAGE_SZ, BTREE_PAGE_SZ);
+    BTree_put32(meta + BT_ROOT, root);
+    BTree_put32(meta + BT_HEIGHT, height);
+    BTree_put32(meta + BT_NR_PAGES, nr_pages);
+    return BTree_write(fp, 0, meta) && !fflush(fp);
+}
+
+/**
+ * @brief Reads the meta page
+ * @param tree: a B+tree, whose file is open
+ * @return true, if it is a valid B+tree; false, otherwise
+ */
+static bool BTree_read_meta(const BTree_T tree)
+{
+    byte *meta = tree->node;
+
+    if( fseek(tree->fp, 0, SEEK_SET) ||
+        fread(meta, BTREE_PAGE_SZ, 1, tree->fp) != 1 ||
+        BTree_get32(meta + BT_CRC) != crc32c(0, meta + 4, BTREE_PAGE_SZ - 4)
+        || memcmp(meta + BT_MAGIC, BTREE_MAGIC, 4) ||
+        BTree_get32(meta + BT_VERSION) != BTREE_VERSION ||
+        BTree_get32(meta + BT_PAGE_SZ) != BTREE_PAGE_SZ )
+        return false;
+    tree->root = BTree_get32(meta + BT_ROOT);
+    tree->height = BTree_get32(meta + BT_HEIGHT);
+    tree->nr_pages = BTree_get32(meta + BT_NR_PAGES);
+    return tree->root < tree->nr_pages && tree->height <= BTREE_MAX_DEPTH;
+}
+
+/**
+ * @brief Descends from the root to the leaf of a key
+ * @param tree: a valid B+tree
+ * @param k: padded key
+ * @param path: filled with the pages from the root to the leaf
+ * @param depth: filled with the depth of the leaf (0: the root)
+ * @return true, if successfull (the leaf is in the node buffer); false,
+ * otherwise (e.g., empty or a torn node)
+ */
+static bool BTree_descend(const BTree_T tree, const byte *k, uint32_t *path,
+                          unsigned *depth)
+{
+    uint32_t no = tree->root;
+    unsigned d, i;
+    bool found;
+
+    for(d = 0; d < BTREE_MAX_DEPTH; d++)
+    {
+        path[d] = no;
+        if( !BTree_read(tree->fp, no, tree->node) )
+            return false;
+        if( BTree_get16(tree->node + BT_LEAF) )
+        {
+            *depth = d;
+            return true;
+        }
+/* The child of the last key not above it */
+        i = BTree_search(tree->node, k, &found) + found;
+        no = i ? (uint32_t)BTree_get64(BTree_entry(tree->node, i - 1) +
+                                       BTREE_KEY_SZ)
+               : BTree_get32(tree->node + BT_CHILD0);
+    }
+    return false;
+}
+
+BTree_T BTree_open(const char *name)
+{
+    BTree_T tree;
+
+    assert(name);
+    tree = calloc(1, sizeof(*tree));
+    assert(tree);
+    tree->name = malloc(strlen(name) + 1);
+    tree->node = malloc(BTREE_PAGE_SZ + BTREE_ENTRY_SZ);
+    tree->split = malloc(BTREE_PAGE_SZ);
+    assert(tree->name && tree->node && tree->split);
+    strcpy(tree->name, name);
+
+    if( (tree->fp = fopen(name, "r+b")) && BTree_read_meta(tree) )
+        return tree;
+/* Missing or invalid: started anew */
+    if(tree->fp)
+        fclose(tree->fp);
+    tree->root = tree->height = 0;
+    tree->nr_pages = 1;
+    if( !(tree->fp = fopen(name, "w+b")) ||
+        !BTree_write_meta(tree->fp, 0, 0, 1) )
+    {
+        BTree_close(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+void BTree_close(BTree_T tree)
+{
+    unsigned i;
+
+    if(!tree)
+        return;
+    if(tree->tmp)
+        BTree_load_end(tree, false);
+    if(tree->fp)
+        fclose(tree->fp);
+    for(i = 0; i < BTREE_MAX_DEPTH; i++)
+        free(tree->load[i]);
+    free(tree->name);
+    free(tree->node);
+    free(tree->split);
+    free(tree);
+}
+
+bool BTree_is_empty(const BTree_T tree)
+{
+    return !tree->root;
+}
+
+bool BTree_get(const BTree_T tree, const char *key, uint64_t *val)
+{
+    uint32_t path[BTREE_MAX_DEPTH];
+    byte k[BTREE_KEY_SZ];
+    unsigned d, i;
+    bool found;
+
+    if( tree->tmp || !tree->root || !BTree_pad(key, k) ||
+        !BTree_descend(tree, k, path, &d) )
+        return false;
+    i = BTree_search(tree->node, k, &found);
+    if(found)
+        *val = BTree_get64(BTree_entry(tree->node, i) + BTREE_KEY_SZ);
+    return found;
+}
+
+bool BTree_put(const BTree_T tree, const char *key, uint64_t val)
+{
+    uint32_t path[BTREE_MAX_DEPTH], right;
+    byte k[BTREE_KEY_SZ], *node = tree->node, *split = tree->split;
+    unsigned d, i, n, half;
+    bool found;
+
+    if(tree->tmp || !BTree_pad(key, k))
+        return false;
+/* First entry: the root is a leaf */
+    if(!tree->root)
+    {
+        memset(node, 0, BTREE_PAGE_SZ);
+        BTree_put16(node + BT_LEAF, 1);
+        BTree_insert_at(node, 0, k, val);
+        tree->root = tree->nr_pages++;
+        tree->height = 1;
+        return BTree_write(tree->fp, tree->root, node) &&
+               BTree_write_meta(tree->fp, tree->root, tree->height,
+                                tree->nr_pages);
+    }
+    if( !BTree_descend(tree, k, path, &d) )
+        return false;
+    i = BTree_search(node, k, &found);
+    if(found)
+    {
+        BTree_put64(BTree_entry(node, i) + BTREE_KEY_SZ, val);
+        return BTree_write(tree->fp, path[d], node) && !fflush(tree->fp);
+    }
+
+/* Up from the leaf: a full node is split, and the upper half's first key
+   goes up, with the new node as its child */
+    for(;;)
+    {
+        BTree_insert_at(node, i, k, val);
+        if( (n = BTree_nr(node)) <= BTREE_CAP )
+            return BTree_write(tree->fp, path[d], node) && !fflush(tree->fp);
+        half = n / 2;
+        right = tree->nr_pages++;
+        memset(split, 0, BTREE_PAGE_SZ);
+        BTree_put16(split + BT_LEAF, BTree_get16(node + BT_LEAF));
+        memcpy(k, BTree_entry(node, half), BTREE_KEY_SZ);
+        if( BTree_get16(node + BT_LEAF) )
+        {
+            memcpy(BTree_entry(split, 0), BTree_entry(node, half),
+                   (n - half) * BTREE_ENTRY_SZ);
+            BTree_put16(split + BT_NR, n - half);
+        }
+        else
+        {
+/* Inner: the middle key's child is the new node's first one */
+            BTree_put32(split + BT_CHILD0, (uint32_t)BTree_get64(
+                        BTree_entry(node, half) + BTREE_KEY_SZ));
+            memcpy(BTree_entry(split, 0), BTree_entry(node, half + 1),
+                   (n - half - 1) * BTREE_ENTRY_SZ);
+            BTree_put16(split + BT_NR, n - half - 1);
+        }
+        BTree_put16(node + BT_NR, half);
+        val = right;
+        if( !BTree_write(tree->fp, path[d], node) ||
+            !BTree_write(tree->fp, right, split) )
+            return false;
+        if(!d)
+            break;
+        if( !BTree_read(tree->fp, path[--d], node) )
+            return false;
+        i = BTree_search(node, k, &found);
+    }
+
+/* The root was split: a new root above both halves */
+    memset(node, 0, BTREE_PAGE_SZ);
+    BTree_put32(node + BT_CHILD0, path[0]);
+    BTree_insert_at(node, 0, k, val);
+    tree->root = tree->nr_pages++;
+    tree->height++;
+    return BTree_write(tree->fp, tree->root, node) &&
+           BTree_write_meta(tree->fp, tree->root, tree->height,
+                            tree->nr_pages);
+}
+
+bool BTree_del(const BTree_T tree, const char *key)
+{
+    uint32_t path[BTREE_MAX_DEPTH];
+    byte k[BTREE_KEY_SZ], *node = tree->node;
+    unsigned d, i, n;
+    bool found;
+
+    if( tree->tmp || !tree->root || !BTree_pad(key, k) ||
+        !BTree_descend(tree, k, path, &d) )
+        return false;
+    i = BTree_search(node, k, &found);
+    if(!found)
+        return false;
+    n = BTree_nr(node);
+    memmove(BTree_entry(node, i), BTree_entry(node, i + 1),
+            (n - i - 1) * BTREE_ENTRY_SZ);
+    BTree_put16(node + BT_NR, n - 1);
+    return BTree_write(tree->fp, path[d], node) && !fflush(tree->fp);
+}
+
+/* ================================ Rebuild ================================ */
+
+/**
+ * @brief Starts a new node in a level of a rebuild
+ * @param tree: a B+tree being rebuilt
+ * @param lvl: level (0: leaves)
+ */
+static void BTree_load_reset(const BTree_T tree, unsigned lvl)
+{
+    memset(tree->load[lvl], 0, BTREE_PAGE_SZ);
+    BTree_put16(tree->load[lvl] + BT_LEAF, !lvl);
+    tree->load_empty[lvl] = true;
+}
+
+static bool BTree_load_push(const BTree_T tree, unsigned lvl, const byte *k,
+                            uint64_t val);
+
+/**
+ * @brief Writes the node of a level of a rebuild, adding it to the level
+ * above, and starts a new one
+ * @param tree: a B+tree being rebuilt
+ * @param lvl: level (0: leaves)
+ * @return true, if successfull; false, otherwise
+ */
+static bool BTree_load_flush(const BTree_T tree, unsigned lvl)
+{
+    uint32_t no = tree->load_pages++;
+    bool ok;
+
+    ok = BTree_write(tree->load_fp, no, tree->load[lvl]) &&
+         BTree_load_push(tree, lvl + 1, tree->low[lvl], no);
+    BTree_load_reset(tree, lvl);
+    return ok;
+}
+
+/**
+ * @brief Adds an entry to a level of a rebuild
+ * @param tree: a B+tree being rebuilt
+ * @param lvl: level (0: leaves)
+ * @param k: padded key
+ * @param val: value (or child)
+ * @return true, if successfull; false, otherwise
+ */
+static bool BTree_load_push(const BTree_T tree, unsigned lvl, const byte *k,
+                            uint64_t val)
+{
+    if(lvl == tree->nr_levels)
+    {
+        if(lvl == BTREE_MAX_DEPTH)
+            return false;
+        if(!tree->load[lvl])
+            tree->load[lvl] = malloc(BTREE_PAGE_SZ + BTREE_ENTRY_SZ);
+        assert(tree->load[lvl]);
+        BTree_load_reset(tree, lvl);
+        tree->nr_levels++;
+    }
+    if( BTree_nr(tree->load[lvl]) == BTREE_CAP &&
+        !BTree_load_flush(tree, lvl) )
+        return false;
+/* The first child of an inner node has no key */
+    if(tree->load_empty[lvl])
+    {
+        tree->load_empty[lvl] = false;
+        memcpy(tree->low[lvl], k, BTREE_KEY_SZ);
+        if(lvl)
+        {
+            BTree_put32(tree->load[lvl] + BT_CHILD0, (uint32_t)val);
+            return true;
+        }
+    }
+    BTree_insert_at(tree->load[lvl], BTree_nr(tree->load[lvl]), k, val);
+    return true;
+}
+
+bool BTree_load_begin(const BTree_T tree)
+{
+    if(tree->tmp)
+        return false; // already rebuilding
+    tree->tmp = malloc(strlen(tree->name) + sizeof(BTREE_TMP_EXT));
+    assert(tree->tmp);
+    strcpy(tree->tmp, tree->name);
+    strcat(tree->tmp, BTREE_TMP_EXT);
+    if( !(tree->load_fp = fopen(tree->tmp, "wb")) )
+    {
+        free(tree->tmp);
+        tree->tmp = NULL;
+        return false;
+    }
+    tree->load_pages = 1; // the meta page is written last
+    tree->load_n = 0;
+    tree->nr_levels = 0;
+    return true;
+}
+
+bool BTree_load_add(const BTree_T tree, const char *key, uint64_t val)
+{
+    byte k[BTREE_KEY_SZ];
+
+    if( !tree->tmp || !BTree_pad(key, k) ||
+        (tree->load_n && memcmp(k, tree->last, BTREE_KEY_SZ) <= 0) )
+        return false;
+    memcpy(tree->last, k, BTREE_KEY_SZ);
+    tree->load_n++;
+    return BTree_load_push(tree, 0, k, val);
+}
+
+bool BTree_load_end(const BTree_T tree, bool commit)
+{
+    uint32_t root = 0, height = 0;
+    unsigned lvl;
+    FILE *fp;
+    bool ok = commit;
+
+    if(!tree->tmp)
+        return false;
+/* The nodes being filled, bottom-up; the top one is the root */
+    for(lvl = 0; ok && tree->load_n && lvl < tree->nr_levels; lvl++)
+        if(lvl + 1 < tree->nr_levels)
+            ok = BTree_load_flush(tree, lvl);
+        else
+        {
+            root = tree->load_pages++;
+            height = lvl + 1;
+            ok = BTree_write(tree->load_fp, root, tree->load[lvl]);
+        }
+    ok = ok && BTree_write_meta(tree->load_fp, root, height,
+                                tree->load_pages);
+    ok = !fclose(tree->load_fp) && ok;
+    tree->load_fp = NULL;
+
+/* The new tree replaces the old one */
+    if( ok && (fp = fopen(tree->tmp, "r+b")) )
+    {
+        if( !rename(tree->tmp, tree->name) )
+        {
+            fclose(tree->fp);
+            tree->fp = fp;
+            tree->root = root;
+            tree->height = height;
+            tree->nr_pages = tree->load_pages;
+        }
+        else
+        {
+            fclose(fp);
+            ok = false;
+        }
+    }
+    else
+        ok = false;
+    if(!ok)
+        remove(tree->tmp);
+    free(tree->tmp);
+    tree->tmp = NULL;
+    return ok;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file btree.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Interface to btree module
+ *
+ * *btree* is a persistent B+tree, in a file of BTREE_PAGE_SZ-byte nodes,
+ * that maps string keys to 64-bit values (e.g., the locators of records,
+ * @see Database_tell_record). Values live in the leaves; the inner nodes
+ * only route, so a lookup reads one node per level: O(log n) page reads,
+ * about 100 entries per node.
+ *
+ * |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+ * | CRC32C | leaf? | nr. of entries | child 0 | key | value | ... |
+ * |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+ *
+ * Keys are stored in BTREE_KEY_SZ bytes, padded with zeros, and compared
+ * byte by byte (as strcmp). Inner nodes hold the child of the keys below
+ * the first key, then, per entry, the child of the keys from it on. Page 0
+ * is the meta page (the magic "EGBT", the version, the page size, the root
+ * and the nr. of pages). Removed entries leave their nodes underfull:
+ * nodes are never merged, the tree is rebuilt by BTree_load_begin instead.
+ * Every node is checked by its CRC32C when read: an index is meant to be
+ * rebuilt from its data, so a torn node just fails the lookups through it.
+ */
+
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief opaque pointer to struct BTree_T.
+ * It hides the implementation details (allows modularity)
+ */
+typedef struct BTree_T *BTree_T;
+
+#define BTREE_PAGE_SZ 4096 /**< Size of a node */
+#define BTREE_KEY_SZ 32 /**< Room for a key (longer keys are not stored) */
+
+/**
+ * @brief Opens a B+tree file, creating it if it does not exist
+ * @param name: name of the file
+ * @return a B+tree; NULL if the file cannot be created
+ *
+ * A file that is not a valid B+tree is started anew, empty.
+ */
+BTree_T BTree_open(const char *name);
+
+/**
+ * @brief Closes a B+tree
+ * @param tree: a B+tree; NULL is ignored
+ */
+void BTree_close(BTree_T tree);
+
+/**
+ * @brief Checks if a B+tree is empty
+ * @param tree: a valid B+tree
+ * @return true, if it has no entries (i.e., none was ever added since it
+ * was started anew); false, otherwise
+ */
+bool BTree_is_empty(const BTree_T tree);
+
+/**
+ * @brief Looks up a key
+ * @param tree: a valid B+tree
+ * @param key: key
+ * @param val: filled with its value
+ * @return true, if found; false, otherwise (or a node is torn)
+ */
+bool BTree_get(const BTree_T tree, const char *key, uint64_t *val);
+
+/**
+ * @brief Adds a key, or replaces its value
+ * @param tree: a valid B+tree
+ * @param key: key (shorter than BTREE_KEY_SZ)
+ * @param val: value
+ * @return true, if successfull; false, otherwise (e.g., a key too long)
+ *
+ * A full node is split in two, up to the root.
+ */
+bool BTree_put(const BTree_T tree, const char *key, uint64_t val);
+
+/**
+ * @brief Removes a key
+ * @param tree: a valid B+tree
+ * @param key: key
+ * @return true, if removed; false, if not found
+ *
+ * A single node write.
+ */
+bool BTree_del(const BTree_T tree, const char *key);
+
+/**
+ * @brief Starts rebuilding a B+tree from sorted entries
+ * @param tree: a valid B+tree
+ * @return true, if successfull; false, otherwise
+ *
+ * The entries are added by BTree_load_add and the new tree replaces the
+ * old one at BTree_load_end, atomically (it is built in a temp file, the
+ * name of the B+tree and ".tmp"). Bottom-up: every node is written once,
+ * full, and only a node per level is held in memory. No other call is
+ * allowed in the meantime.
+ */
+bool BTree_load_begin(const BTree_T tree);
+
+/**
+ * @brief Adds an entry to a B+tree being rebuilt
+ * @param tree: a valid B+tree, being rebuilt
+ * @param key: key, greater than the previous one's
+ * @param val: value
+ * @return true, if added; false, otherwise (e.g., out of order or too long;
+ * the entry is skipped)
+ */
+bool BTree_load_add(const BTree_T tree, const char *key, uint64_t val);
+
+/**
+ * @brief Finishes rebuilding a B+tree
+ * @param tree: a valid B+tree, being rebuilt
+ * @param commit: true, to replace the old tree; false, to keep it
+ * @return true, if the new tree replaced the old one; false, otherwise
+ * (the old one is kept)
+ */
+bool BTree_load_end(const BTree_T tree, bool commit);
+
+#endif // BTREE_H
@@ -0,0 +1,120 @@
+/**
+ * @file crc32c.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief crc32c's module implementation
+ */
+
+#include "crc32c.h"
+#include <stdbool.h>
+#include <string.h> // memcpy
+
+#define CRC32C_POLY 0x82f63b78 /**< Castagnoli polynomial (reflected) */
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC32C_HW /**< SSE4.2 can be detected and used at run time */
+#include <nmmintrin.h>
+#endif
+
+/**
+ * @brief Tables of slicing-by-8: table[k][b] is the CRC of byte b followed
+ * by k zero bytes
+ */
+static uint32_t crc32c_table[8][256];
+static bool crc32c_table_ready = false; /**< tables are filled in */
+
+/**
+ * @brief Fills in the tables of slicing-by-8 (once)
+ */
+static void crc32c_init_table(void)
+{
+    uint32_t crc;
+    unsigned b, k, bit;
+
+    for(b = 0; b < 256; b++)
+    {
+        crc = b;
+        for(bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (CRC32C_POLY & -(crc & 1));
+        crc32c_table[0][b] = crc;
+    }
+    for(b = 0; b < 256; b++)
+        for(k = 1; k < 8; k++)
+            crc32c_table[k][b] = (crc32c_table[k - 1][b] >> 8) ^
+                crc32c_table[0][crc32c_table[k - 1][b] & 0xff];
+    crc32c_table_ready = true;
+}
+
+/**
+ * @brief CRC-32C in software: slicing-by-8
+ * @param crc: running CRC (inverted)
+ * @param p: data
+ * @param len: length of data
+ * @return running CRC (inverted)
+ */
+static uint32_t crc32c_sw(uint32_t crc, const unsigned char *p, size_t len)
+{
+    uint32_t lo, hi;
+
+    if(!crc32c_table_ready)
+        crc32c_init_table();
+
+/* 8 bytes per iteration: 8 independent lookups */
+    for(; len >= 8; len -= 8, p += 8)
+    {
+        lo = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                    (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        hi = (uint32_t)p[4] | (uint32_t)p[5] << 8 |
+             (uint32_t)p[6] << 16 | (uint32_t)p[7] << 24;
+        crc = crc32c_table[7][lo & 0xff] ^ crc32c_table[6][(lo >> 8) & 0xff] ^
+              crc32c_table[5][(lo >> 16) & 0xff] ^ crc32c_table[4][lo >> 24] ^
+              crc32c_table[3][hi & 0xff] ^ crc32c_table[2][(hi >> 8) & 0xff] ^
+              crc32c_table[1][(hi >> 16) & 0xff] ^ crc32c_table[0][hi >> 24];
+    }
+/* Remaining bytes, one at a time */
+    while(len--)
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xff];
+    return crc;
+}
+
+#ifdef CRC32C_HW
+/**
+ * @brief CRC-32C in hardware: SSE4.2 crc32 instruction
+ * @param crc: running CRC (inverted)
+ * @param p: data
+ * @param len: length of data
+ * @return running CRC (inverted)
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const unsigned char *p, size_t len)
+{
+    uint64_t crc64 = crc, word;
+
+/* 8 bytes per instruction (unaligned loads are fine on x86) */
+    for(; len >= 8; len -= 8, p += 8)
+    {
+        memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (uint32_t)crc64;
+    while(len--)
+        crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+#endif
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    if(!data)
+        return crc;
+
+    crc = ~crc;
+#ifdef CRC32C_HW
+    if( __builtin_cpu_supports("sse4.2") )
+        return ~crc32c_hw(crc, p, len);
+#endif
+    return ~crc32c_sw(crc, p, len);
+}
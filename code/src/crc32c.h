@@ -0,0 +1,29 @@
+/**
+ * @file crc32c.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Interface to crc32c module
+ *
+ * *crc32c* computes the CRC-32C (Castagnoli) checksum, used to detect
+ * corrupted or torn records in the database. It uses the SSE4.2 crc32
+ * instruction when the CPU has it, and a slicing-by-8 table lookup
+ * otherwise (8 bytes per iteration); both give the same result.
+ */
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Computes or extends a CRC-32C
+ * @param crc: CRC of the preceding data; 0 to start
+ * @param data: data to checksum
+ * @param len: length of data
+ * @return CRC of the preceding data followed by *data*
+ */
+uint32_t crc32c(uint32_t crc, const void *data, size_t len);
+
+#endif // CRC32C_H
@@ -6,13 +6,11 @@
  * @brief fifo's module implementation
  */
 
-#ifndef FIFO_H
-#define FIFO_H
-
 #include <stdio.h>
 #include <stdbool.h>
 #include <assert.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "fifo.h"
 
 /**
@@ -23,6 +21,9 @@
  */
 typedef unsigned char byte;
 
+#define FIFO_MIN_SZ 64 /**< Min. size of the FIFO's buffer when it grows */
+#define FIFO_CACHE_LINE 64 /**< Size of a cache line, in bytes */
+
 /**
  * @brief Fifo's struct: contains the relevant data members
  */
@@ -30,8 +31,19 @@ struct Fifo_T
 {
     size_t rd; /**< FIFO's read index */
     size_t wr; /**< FIFO's write index */
-    size_t size; /**< Size of the fifo */
+    size_t size; /**< Size of the fifo (allocated bytes) */
     byte *data; /**< Fifo's data */
+    bool owned; /**< false, if data is borrowed from another FIFO */
+    unsigned version; /**< format version of the data */
+    /* Ring mode: indexes run freely and are masked to address data; the
+       producer's and the consumer's members are in separate cache lines */
+    size_t mask; /**< ring: size - 1 (size is a power of two); 0 if linear */
+    char pad1[FIFO_CACHE_LINE]; /**< separates the producer's members */
+    atomic_size_t head; /**< ring: write index (written by the producer) */
+    size_t tail_cache; /**< ring: producer's last read of tail */
+    char pad2[FIFO_CACHE_LINE]; /**< separates the consumer's members */
+    atomic_size_t tail; /**< ring: read index (written by the consumer) */
+    size_t head_cache; /**< ring: consumer's last read of head */
 };
 
 /**
@@ -49,34 +61,64 @@ static Fifo_T Fifo_new()
 }
 
 /**
- * @brief Checks if FIFO is full
+ * @brief Resizes the FIFO's buffer
  * @param fifo: a valid FIFO
- * @return true if full; false otherwise
+ * @param sz: new size; indexes beyond it are clamped
  */
-static bool Fifo_isFull(const Fifo_T fifo)
+static void Fifo_resize(Fifo_T fifo, size_t sz)
 {
-    return (fifo->wr == fifo->size);
-}
+    byte *data = NULL;
 
-/**
- * @brief Checks if FIFO is empty
- * @param fifo: a valid FIFO
- * @return true if empty; false otherwise
- */
-static bool Fifo_isEmpty(const Fifo_T fifo)
-{
-    return (fifo->wr == fifo->rd);
+/* Borrowed data is never reallocated nor freed: copy it on resize */
+    if(!fifo->owned)
+    {
+        if(sz)
+        {
+            data = malloc(sz);
+            assert(data);
+            memcpy(data, fifo->data, (fifo->wr < sz) ? fifo->wr : sz);
+        }
+        fifo->owned = true;
+    }
+    else if(sz)
+    {
+        data = realloc(fifo->data, sz);
+        assert(data);
+    }
+    else
+        free(fifo->data);
+    fifo->data = data;
+    fifo->size = sz;
+    if(fifo->wr > sz)
+        fifo->wr = sz;
+    if(fifo->rd > fifo->wr)
+        fifo->rd = fifo->wr;
 }
 
 Fifo_T Fifo_ctor(size_t sz)
 {
     Fifo_T fifo = Fifo_new();
-    fifo->size = sz;
+    fifo->size = 0;
     fifo->rd = fifo->wr = 0;
-    fifo->data = malloc(sz);
-    assert(fifo->data);
-    /* Clearing out trash from fifo */
-    memset(fifo->data,'\0', sz);
+    fifo->data = NULL;
+    fifo->owned = true;
+    fifo->version = FIFO_VERSION;
+    fifo->mask = 0;
+    /* Only written bytes are ever read: no need to clear the buffer */
+    Fifo_resize(fifo, sz);
+    return fifo;
+}
+
+Fifo_T Fifo_borrow(const void *data, size_t len)
+{
+    Fifo_T fifo = Fifo_new();
+
+    fifo->data = (byte *)data;
+    fifo->owned = false;
+    fifo->version = FIFO_VERSION;
+    fifo->mask = 0;
+    fifo->size = fifo->wr = (data ? len : 0);
+    fifo->rd = 0;
     return fifo;
 }
 
@@ -84,12 +126,18 @@ void Fifo_dtor(Fifo_T fifo)
 {
     if(!fifo)
         return;
-    if(fifo->data)
+    if(fifo->data && fifo->owned)
         free(fifo->data);
        
     free(fifo);
 }
 
+void Fifo_reset(Fifo_T fifo)
+{
+    if(fifo)
+        fifo->rd = fifo->wr = 0;
+}
+
 void Fifo_print(Fifo_T fifo, size_t len)
 {
     if(!fifo->data)
@@ -103,12 +151,38 @@ void Fifo_print(Fifo_T fifo, size_t len)
     }
 }
 
+bool Fifo_reserve(Fifo_T fifo, size_t sz)
+{
+    size_t size;
+
+    if(!fifo)
+        return false;
+    if(sz <= fifo->size)
+        return true;
+    if(fifo->mask)
+        return false; // rings never grow
+
+/* Grow geometrically: amortized O(1) per pushed byte */
+    size = (fifo->size < FIFO_MIN_SZ) ? FIFO_MIN_SZ : fifo->size;
+    while(size < sz)
+        size *= 2;
+    Fifo_resize(fifo, size);
+    return true;
+}
+
+void Fifo_shrink_to_fit(Fifo_T fifo)
+{
+    if(fifo && fifo->size > fifo->wr)
+        Fifo_resize(fifo, fifo->wr);
+}
+
 size_t Fifo_push(Fifo_T fifo, const void *data, size_t len)
 {
     if(!data || len < 1)
         return 0;
     
-    if( Fifo_isFull(fifo) )
+    /* Make room: never drop data */
+    if( !Fifo_reserve(fifo, fifo->wr + len) )
         return 0;
 
     memcpy( &(*(fifo->data + fifo->wr)), data, len);
@@ -123,7 +197,8 @@ size_t Fifo_pop(const Fifo_T fifo, void *data, size_t len)
     if(!data || len < 1)
         return 0;
 
-    if( Fifo_isEmpty(fifo) )
+    /* Never read beyond what was written */
+    if( len > fifo->wr - fifo->rd )
         return 0;
 
     memcpy( data,  &(*(fifo->data + fifo->rd)), len);
@@ -133,6 +208,242 @@ size_t Fifo_pop(const Fifo_T fifo, void *data, size_t len)
     return (fifo->rd += len);
 }
 
+size_t Fifo_push_uvar(Fifo_T fifo, unsigned long long val)
+{
+    byte buf[FIFO_VARINT_MAX];
+    size_t len = 0;
+
+/* 7 bits per byte, least significant first; high bit: more follow */
+    while(val >= 0x80)
+    {
+        buf[len++] = (byte)(val | 0x80);
+        val >>= 7;
+    }
+    buf[len++] = (byte)val;
+    return Fifo_push(fifo, buf, len);
+}
+
+size_t Fifo_pop_uvar(const Fifo_T fifo, unsigned long long *val)
+{
+    unsigned long long res = 0;
+    size_t rd;
+    unsigned shift;
+    byte b;
+
+    if(!fifo || !val)
+        return 0;
+
+    for(rd = fifo->rd, shift = 0; rd < fifo->wr && shift < 64; shift += 7)
+    {
+        b = fifo->data[rd++];
+        res |= (unsigned long long)(b & 0x7f) << shift;
+        if( !(b & 0x80) )
+        {
+            *val = res;
+            return (fifo->rd = rd);
+        }
+    }
+    return 0; // truncated or overlong
+}
+
+size_t Fifo_push_svar(Fifo_T fifo, long long val)
+{
+/* Zigzag: the sign goes to the least significant bit */
+    return Fifo_push_uvar(fifo, ((unsigned long long)val << 1) ^ 
+                                (unsigned long long)(val >> 63));
+}
+
+size_t Fifo_pop_svar(const Fifo_T fifo, long long *val)
+{
+    unsigned long long u;
+    size_t rd;
+
+    if( !val || !(rd = Fifo_pop_uvar(fifo, &u)) )
+        return 0;
+    *val = (long long)(u >> 1) ^ -(long long)(u & 1);
+    return rd;
+}
+
+size_t Fifo_uvar_size(unsigned long long val)
+{
+    size_t len = 1;
+
+    while(val >= 0x80)
+    {
+        val >>= 7;
+        len++;
+    }
+    return len;
+}
+
+size_t Fifo_svar_size(long long val)
+{
+    return Fifo_uvar_size(((unsigned long long)val << 1) ^ 
+                          (unsigned long long)(val >> 63));
+}
+
+size_t Fifo_push_size(Fifo_T fifo, size_t sz)
+{
+    if(fifo->version == FIFO_VERSION_LEGACY)
+        return Fifo_push(fifo, &sz, sizeof(sz));
+    return Fifo_push_uvar(fifo, sz);
+}
+
+size_t Fifo_pop_size(const Fifo_T fifo, size_t *sz)
+{
+    unsigned long long val;
+    size_t rd;
+
+    if(!fifo || !sz)
+        return 0;
+    if(fifo->version == FIFO_VERSION_LEGACY)
+        return Fifo_pop(fifo, sz, sizeof(*sz));
+    if( !(rd = Fifo_pop_uvar(fifo, &val)) )
+        return 0;
+    *sz = val;
+    return rd;
+}
+
+size_t Fifo_push_str(Fifo_T fifo, const char *str)
+{
+    size_t len = strlen(str) + 1; // with terminator
+
+    Fifo_push_size(fifo, len);
+    return Fifo_push(fifo, str, len);
+}
+
+size_t Fifo_str_size(const char *str)
+{
+    size_t len = strlen(str) + 1; // with terminator
+
+    return Fifo_uvar_size(len) + len;
+}
+
+const void * Fifo_view(const Fifo_T fifo, size_t len)
+{
+    const byte *data;
+
+    /* Never read beyond what was written */
+    if( !fifo || len > fifo->wr - fifo->rd )
+        return NULL;
+
+    data = fifo->data + fifo->rd;
+    fifo->rd += len;
+    return data;
+}
+
+const char * Fifo_view_str(const Fifo_T fifo)
+{
+    size_t len, rd;
+    const char *str;
+
+    if(!fifo)
+        return NULL;
+    rd = fifo->rd;
+/* Length (including the terminator) followed by the string */
+    if( !Fifo_pop_size(fifo, &len) || len < 1 ||
+        !(str = Fifo_view(fifo, len)) || str[len - 1] != '\0' )
+    {
+        fifo->rd = rd; // nothing is consumed on error
+        return NULL;
+    }
+    return str;
+}
+
+Fifo_T Fifo_slice(const Fifo_T fifo, size_t len)
+{
+    const byte *data = Fifo_view(fifo, len);
+    Fifo_T slice;
+
+    if(!data)
+        return NULL;
+    slice = Fifo_borrow(data, len);
+    slice->version = fifo->version;
+    return slice;
+}
+
+Fifo_T Fifo_ring_ctor(size_t sz)
+{
+    size_t size = FIFO_MIN_SZ;
+    Fifo_T fifo;
+
+/* Power-of-two size: indexes are masked instead of divided */
+    while(size < sz)
+        size *= 2;
+    fifo = Fifo_ctor(size);
+    fifo->mask = size - 1;
+    atomic_init(&fifo->head, 0);
+    atomic_init(&fifo->tail, 0);
+    fifo->tail_cache = fifo->head_cache = 0;
+    return fifo;
+}
+
+size_t Fifo_ring_push(Fifo_T fifo, const void *data, size_t len)
+{
+    size_t head, pos, first;
+
+    if(!data || len < 1)
+        return 0;
+
+    head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+/* Room left; only reload tail (shared with the consumer) if short of it */
+    if(len > fifo->size - (head - fifo->tail_cache))
+    {
+        fifo->tail_cache = atomic_load_explicit(&fifo->tail, 
+                                                memory_order_acquire);
+        if(len > fifo->size - (head - fifo->tail_cache))
+            return 0;
+    }
+
+/* Copy, wrapping around the end of the buffer */
+    pos = head & fifo->mask;
+    first = fifo->size - pos;
+    if(first > len)
+        first = len;
+    memcpy(fifo->data + pos, data, first);
+    memcpy(fifo->data, (const byte *)data + first, len - first);
+
+/* Publish: the data is written before the consumer sees the new head */
+    atomic_store_explicit(&fifo->head, head + len, memory_order_release);
+    return len;
+}
+
+size_t Fifo_ring_pop(const Fifo_T fifo, void *data, size_t len)
+{
+    size_t tail, pos, first;
+
+    if(!data || len < 1)
+        return 0;
+
+    tail = atomic_load_explicit(&fifo->tail, memory_order_relaxed);
+/* Bytes available; only reload head (shared with the producer) if short */
+    if(len > fifo->head_cache - tail)
+    {
+        fifo->head_cache = atomic_load_explicit(&fifo->head, 
+                                                memory_order_acquire);
+        if(len > fifo->head_cache - tail)
+            return 0;
+    }
+
+/* Copy, wrapping around the end of the buffer */
+    pos = tail & fifo->mask;
+    first = fifo->size - pos;
+    if(first > len)
+        first = len;
+    memcpy(data, fifo->data + pos, first);
+    memcpy((byte *)data + first, fifo->data, len - first);
+
+/* Release the room: the data is copied before the producer reuses it */
+    atomic_store_explicit(&fifo->tail, tail + len, memory_order_release);
+    return len;
+}
+
+size_t Fifo_ring_count(const Fifo_T fifo)
+{
+    return atomic_load_explicit(&fifo->head, memory_order_acquire) -
+           atomic_load_explicit(&fifo->tail, memory_order_acquire);
+}
+
 size_t Fifo_get_size(const Fifo_T fifo)
 {
     return fifo->size;
@@ -155,7 +466,15 @@ void Fifo_set_write_idx(Fifo_T fifo, const size_t idx)
 
 void Fifo_set_size(Fifo_T fifo, const size_t idx)
 {
-    fifo->size = idx;
+    Fifo_resize(fifo, idx);
+}
+
+unsigned Fifo_get_version(const Fifo_T fifo)
+{
+    return fifo->version;
 }
 
-#endif // FIFO_H
+void Fifo_set_version(Fifo_T fifo, unsigned version)
+{
+    fifo->version = version;
+}
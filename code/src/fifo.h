@@ -5,10 +5,27 @@
  *
  * @brief First-in, First-out (FIFO) module
  *
- * Module for FIFO management, used in serialization/deserialization of objects
+ * Module for FIFO management, used in serialization/deserialization of objects.
+ * The FIFO's buffer grows geometrically on push, so data is never dropped.
+ *
+ * Integers can be pushed as *varints* (LEB128): 7 bits per byte, the high
+ * bit flags that more bytes follow, so small values take a single byte.
+ * Signed integers are zigzag mapped first (0, -1, 1, -2, ... -> 0, 1, 2, 3,
+ * ...), so small negative values are small too.
+ * Every FIFO has a format *version*, which defines how sizes (length 
+ * prefixes) are encoded, so data written by older versions remains readable.
+ *
+ * A FIFO constructed by Fifo_ring_ctor is a *ring*: a circular buffer with
+ * a fixed, power-of-two size, shared without locks by one producer thread 
+ * (Fifo_ring_push) and one consumer thread (Fifo_ring_pop). Only the ring 
+ * functions, Fifo_dtor and the getters apply to rings.
  */
 
+#ifndef FIFO_H
+#define FIFO_H
+
 #include <stdlib.h>
+#include <stdbool.h>
 
 /**
  * @brief opaque pointer to struct Fifo_T. 
@@ -16,19 +33,55 @@
  */
 typedef struct Fifo_T *Fifo_T;
 
+/* Format versions */
+#define FIFO_VERSION_LEGACY 0 /**< sizes as raw size_t; fixed-width fields */
+#define FIFO_VERSION_VARINT 1 /**< sizes and integers as varints */
+#define FIFO_VERSION_CRC 2 /**< as VARINT; records framed with a CRC32C */
+#define FIFO_VERSION_FLAGS 3 /**< as CRC; file flags (e.g., compression) */
+#define FIFO_VERSION FIFO_VERSION_FLAGS /**< version of the data written */
+
+#define FIFO_VARINT_MAX 10 /**< max. nr. of bytes of a 64-bit varint */
+
 /**
  * @brief Constructs a FIFO
- * @param sz: size of the FIFO
+ * @param sz: initial size of the FIFO; the exact size, if known, avoids
+ * any reallocation
  * @return a constructed Fifo with default values
  */
 Fifo_T Fifo_ctor(size_t sz);
 
+/**
+ * @brief Constructs a ring (single-producer/single-consumer FIFO)
+ * @param sz: min. size of the ring; it is rounded up to a power of two
+ * @return a constructed, empty ring
+ */
+Fifo_T Fifo_ring_ctor(size_t sz);
+
+/**
+ * @brief Constructs a read-only FIFO over external data
+ * @param data: data to read from; it is borrowed, not copied
+ * @param len: length of data
+ * @return a constructed FIFO, whose write index is *len*
+ *
+ * The data must outlive the FIFO and its slices. @see Fifo_slice
+ */
+Fifo_T Fifo_borrow(const void *data, size_t len);
+
 /**
  * @brief Destructs a FIFO
  * @param fifo: a valid FIFO
  */
 void Fifo_dtor(Fifo_T fifo);
 
+/**
+ * @brief Empties a FIFO, keeping its buffer for reuse
+ * @param fifo: a valid FIFO (not a ring)
+ *
+ * Resets the read and write indexes; no memory is released, so a FIFO 
+ * reused across many records only grows up to the largest one.
+ */
+void Fifo_reset(Fifo_T fifo);
+
 /**
  * @brief Prints the desired length of FIFO 
  * @param fifo: a valid FIFO
@@ -36,13 +89,29 @@ void Fifo_dtor(Fifo_T fifo);
  */
 void Fifo_print(Fifo_T fifo, size_t len);
 
+/**
+ * @brief Reserves room in the FIFO
+ * @param fifo: a valid FIFO
+ * @param sz: total size required
+ * @return true, if the FIFO's size is at least *sz*; false otherwise 
+ * (rings never grow)
+ */
+bool Fifo_reserve(Fifo_T fifo, size_t sz);
+
+/**
+ * @brief Releases the FIFO's unused room (beyond the write index)
+ * @param fifo: a valid FIFO
+ */
+void Fifo_shrink_to_fit(Fifo_T fifo);
+
 /**
  * @brief Pushes an element to FIFO 
  * @param fifo: a valid FIFO
  * @param data: elem to push
  * @param len: length of elem to push
- * @return the actual size pushed to FIFO; can be compared with the 
- * element's size to check for errors
+ * @return the write index after the push; 0 if nothing was pushed
+ *
+ * The FIFO grows as needed (except rings: @see Fifo_ring_push).
  */
 size_t Fifo_push(Fifo_T fifo, const void *data, size_t len);
 
@@ -50,16 +119,168 @@ size_t Fifo_push(Fifo_T fifo, const void *data, size_t len);
  * @brief Pop an element from FIFO 
  * @param fifo: a valid FIFO
  * @param data: elem to pop to
- * @param len: length of elem to push
- * @return the actual size pushed to FIFO; can be compared with the 
- * element's size to check for errors
+ * @param len: length of elem to pop
+ * @return the read index after the pop; 0 if there were less than *len*
+ * bytes left to read (nothing is popped)
  */
 size_t Fifo_pop(const Fifo_T fifo, void *data, size_t len);
 
+/**
+ * @brief Pushes an unsigned integer to FIFO as a varint
+ * @param fifo: a valid FIFO
+ * @param val: value to push
+ * @return the write index after the push
+ */
+size_t Fifo_push_uvar(Fifo_T fifo, unsigned long long val);
+
+/**
+ * @brief Pops a varint from FIFO as an unsigned integer
+ * @param fifo: a valid FIFO
+ * @param val: value to pop to
+ * @return the read index after the pop; 0 if the varint is truncated or
+ * overlong (nothing is popped)
+ */
+size_t Fifo_pop_uvar(const Fifo_T fifo, unsigned long long *val);
+
+/**
+ * @brief Pushes a signed integer to FIFO as a zigzag varint
+ * @param fifo: a valid FIFO
+ * @param val: value to push
+ * @return the write index after the push
+ */
+size_t Fifo_push_svar(Fifo_T fifo, long long val);
+
+/**
+ * @brief Pops a zigzag varint from FIFO as a signed integer
+ * @param fifo: a valid FIFO
+ * @param val: value to pop to
+ * @return the read index after the pop; 0 on error (nothing is popped)
+ */
+size_t Fifo_pop_svar(const Fifo_T fifo, long long *val);
+
+/**
+ * @brief Gets the encoded size of an unsigned varint
+ * @param val: value to encode
+ * @return nr. of bytes, from 1 to FIFO_VARINT_MAX
+ */
+size_t Fifo_uvar_size(unsigned long long val);
+
+/**
+ * @brief Gets the encoded size of a signed (zigzag) varint
+ * @param val: value to encode
+ * @return nr. of bytes, from 1 to FIFO_VARINT_MAX
+ */
+size_t Fifo_svar_size(long long val);
+
+/**
+ * @brief Pushes a size (length prefix) to FIFO, encoded as per its version
+ * @param fifo: a valid FIFO
+ * @param sz: size to push
+ * @return the write index after the push
+ */
+size_t Fifo_push_size(Fifo_T fifo, size_t sz);
+
+/**
+ * @brief Pops a size (length prefix) from FIFO, decoded as per its version
+ * @param fifo: a valid FIFO
+ * @param sz: size to pop to
+ * @return the read index after the pop; 0 on error (nothing is popped)
+ */
+size_t Fifo_pop_size(const Fifo_T fifo, size_t *sz);
+
+/**
+ * @brief Pushes a length-prefixed string to FIFO
+ * @param fifo: a valid FIFO
+ * @param str: string to push
+ * @return the write index after the push
+ *
+ * The length includes the terminator. @see Fifo_view_str
+ */
+size_t Fifo_push_str(Fifo_T fifo, const char *str);
+
+/**
+ * @brief Gets the encoded size of a length-prefixed string, in the 
+ * current version
+ * @param str: string to encode
+ * @return nr. of bytes
+ */
+size_t Fifo_str_size(const char *str);
+
+/**
+ * @brief Views an element of the FIFO without copying it
+ * @param fifo: a valid FIFO
+ * @param len: length of the element
+ * @return pointer to the element inside the FIFO's buffer; NULL if there
+ * were less than *len* bytes left to read
+ *
+ * Advances the read index like Fifo_pop. The pointer is read-only and is 
+ * valid while the FIFO's buffer is (i.e., until it is destructed or grows).
+ */
+const void * Fifo_view(const Fifo_T fifo, size_t len);
+
+/**
+ * @brief Views a length-prefixed string of the FIFO without copying it
+ * @param fifo: a valid FIFO
+ * @return pointer to the string inside the FIFO's buffer; NULL if the length
+ * is invalid or the string is not terminated (nothing is consumed)
+ *
+ * Strings are serialized as their length (including the terminator)
+ * followed by their characters. @see Fifo_pop_size, Fifo_view
+ */
+const char * Fifo_view_str(const Fifo_T fifo);
+
+/**
+ * @brief Slices an element of the FIFO into a FIFO of its own
+ * @param fifo: a valid FIFO
+ * @param len: length of the slice
+ * @return FIFO that borrows *len* bytes of *fifo*'s buffer; NULL if there
+ * were less than *len* bytes left to read
+ *
+ * Advances the read index like Fifo_pop. No data is copied, unless the 
+ * slice grows. The slice must be destructed with Fifo_dtor and is only 
+ * valid while the FIFO's buffer is. It has the FIFO's version.
+ */
+Fifo_T Fifo_slice(const Fifo_T fifo, size_t len);
+
+/**
+ * @brief Pushes an element to a ring (producer thread only)
+ * @param fifo: a valid ring
+ * @param data: elem to push
+ * @param len: length of elem to push
+ * @return *len*, if pushed; 0 if there is no room for it (nothing is 
+ * pushed: retry once the consumer pops)
+ *
+ * Lock-free: the element is published to the consumer with release 
+ * semantics, so it is fully written when the consumer sees it.
+ */
+size_t Fifo_ring_push(Fifo_T fifo, const void *data, size_t len);
+
+/**
+ * @brief Pops an element from a ring (consumer thread only)
+ * @param fifo: a valid ring
+ * @param data: elem to pop to
+ * @param len: length of elem to pop
+ * @return *len*, if popped; 0 if there were less than *len* bytes in the 
+ * ring (nothing is popped)
+ *
+ * Lock-free: the room is handed back to the producer with release 
+ * semantics, so it is only reused after the element is copied out.
+ */
+size_t Fifo_ring_pop(const Fifo_T fifo, void *data, size_t len);
+
+/**
+ * @brief Gets the nr. of bytes in a ring
+ * @param fifo: a valid ring
+ * @return nr. of bytes pushed and not yet popped; exact only in the 
+ * producer or the consumer thread, when the other one is idle
+ */
+size_t Fifo_ring_count(const Fifo_T fifo);
+
 /**
  * @brief Gets FIFO's size 
  * @param fifo: a valid FIFO
- * @return size of FIFO
+ * @return size of FIFO (allocated bytes); the written length is given
+ * by the write index
  */
 size_t Fifo_get_size(const Fifo_T fifo);
 
@@ -84,9 +305,27 @@ size_t Fifo_get_write_idx(const Fifo_T fifo);
  */
 void Fifo_set_write_idx(Fifo_T fifo, const size_t idx);
 
+/**
+ * @brief Gets FIFO's format version
+ * @param fifo: a valid FIFO
+ * @return format version: FIFO_VERSION, for FIFOs constructed by Fifo_ctor
+ */
+unsigned Fifo_get_version(const Fifo_T fifo);
+
+/**
+ * @brief Sets FIFO's format version
+ * @param fifo: a valid FIFO
+ * @param version: format version of the data in the FIFO 
+ * (e.g., read from a file)
+ */
+void Fifo_set_version(Fifo_T fifo, unsigned version);
+
 /**
  * @brief Sets FIFO's size
  * @param fifo: a valid FIFO
- * @param idx: new size value
+ * @param idx: new size value; the buffer is reallocated and the indexes 
+ * are clamped to it
  */
 void Fifo_set_size(Fifo_T fifo, const size_t idx);
+
+#endif // FIFO_H
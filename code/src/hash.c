@@ -0,0 +1,243 @@
+/**
+ * @file hash.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Hash module implementation
+ */
+
+#include "hash.h"
+#include <stdlib.h> // malloc
+#include <assert.h> // assert
+#include <ctype.h> // tolower
+
+#define HASH_INIT_SZ 16 /**< Initial nr. of slots (power of 2) */
+#define HASH_LOAD_NUM 7 /**< Max. load factor numerator (used + deleted) */
+#define HASH_LOAD_DEN 10 /**< Max. load factor denominator */
+
+/**
+ * @brief Marker for deleted slots: keeps probe sequences unbroken
+ */
+static char hash_tombstone;
+#define HASH_DELETED ((void *)&hash_tombstone) /**< Deleted slot marker */
+
+/**
+ * @brief Hash slot: pointer to data plus its cached hash value
+ *
+ * Caching the hash avoids calling the comparator for most collisions.
+ */
+struct Slot_T{
+    void *data; /**< generic data; NULL if empty; HASH_DELETED if deleted */
+    unsigned hash; /**< cached hash of data */
+};
+
+/**
+ * @brief Hash's structure: open addressing with linear probing
+ */
+struct Hash_T{
+    struct Slot_T *slots; /**< array of slots */
+    unsigned size; /**< nr. of slots (power of 2) */
+    unsigned count; /**< nr. of elements */
+    unsigned deleted; /**< nr. of deleted slots */
+    unsigned (*Data_hash)(const void *data); /**< pointer to Data hash function */
+    int (*Data_cmp)(const void *data1, const void *data2); /**< pointer to Data compare function */
+};
+
+/**
+ * @brief Allocates memory for an Hash's instance
+ * @return initialized memory for Hash
+ *
+ * It is checked by assert to determine if memory was allocated.
+ * If assertion is valid, returns a valid memory address
+ */
+static Hash_T Hash_new()
+{
+    Hash_T hash = malloc(sizeof(*hash));
+    assert(hash);
+    return hash;
+}
+
+/**
+ * @brief Allocates an array of empty slots
+ * @param size: nr. of slots
+ * @return array of empty slots
+ */
+static struct Slot_T * Hash_slots_new(unsigned size)
+{
+    struct Slot_T *slots = calloc(size, sizeof(*slots));
+    assert(slots);
+    return slots;
+}
+
+/**
+ * @brief Places data in the first free slot of its probe sequence
+ * @param self: a valid hash index with room for one more element
+ * @param data: data to place
+ * @param h: hash of data
+ */
+static void Hash_place(Hash_T self, void *data, unsigned h)
+{
+    unsigned mask = self->size - 1, i = h & mask;
+
+    while(self->slots[i].data && self->slots[i].data != HASH_DELETED)
+        i = (i + 1) & mask;
+    if(self->slots[i].data == HASH_DELETED)
+        self->deleted--;
+    self->slots[i].data = data;
+    self->slots[i].hash = h;
+}
+
+/**
+ * @brief Resizes the slot array and rehashes every element
+ * @param self: a valid hash index
+ * @param size: new nr. of slots (power of 2)
+ *
+ * Deleted slots are dropped on the way.
+ */
+static void Hash_resize(Hash_T self, unsigned size)
+{
+    struct Slot_T *old = self->slots;
+    unsigned i, old_size = self->size;
+
+    self->slots = Hash_slots_new(size);
+    self->size = size;
+    self->deleted = 0;
+    for(i = 0; i < old_size; i++)
+        if(old[i].data && old[i].data != HASH_DELETED)
+            Hash_place(self, old[i].data, old[i].hash);
+    free(old);
+}
+
+/**
+ * @brief Finds the slot holding an element with the same key
+ * @param self: a valid hash index
+ * @param elem: comparable element
+ * @param h: hash of elem
+ * @return matching slot; NULL otherwise
+ */
+static struct Slot_T * Hash_find(const Hash_T self, const void *elem,
+                                 unsigned h)
+{
+    unsigned mask = self->size - 1, i = h & mask;
+    struct Slot_T *slot;
+
+    while( (slot = &self->slots[i])->data )
+    {
+        if(slot->data != HASH_DELETED && slot->hash == h &&
+           !self->Data_cmp(elem, slot->data))
+            return slot;
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+Hash_T Hash_ctor(unsigned (*Data_hash)(const void *data),
+                 int (*Data_cmp)(const void *data1, const void *data2))
+{
+    Hash_T hash = Hash_new();
+    hash->Data_hash = Data_hash;
+    hash->Data_cmp = Data_cmp;
+    hash->size = HASH_INIT_SZ;
+    hash->count = hash->deleted = 0;
+    hash->slots = Hash_slots_new(hash->size);
+    return hash;
+}
+
+void Hash_dtor(Hash_T self)
+{
+    if(!self)
+        return;
+    free(self->slots);
+    free(self);
+}
+
+void * Hash_insert(Hash_T self, const void *elem, const bool allowDups)
+{
+    if(!self || !elem)
+        return NULL;
+
+    unsigned h = self->Data_hash(elem), size;
+
+/* Repeated element */
+    if(!allowDups && Hash_find(self, elem, h))
+        return NULL;
+
+/* Keep the load factor (including deleted slots) bounded */
+    if( (self->count + self->deleted + 1) * HASH_LOAD_DEN >
+        self->size * HASH_LOAD_NUM )
+    {
+        /* Grow if live elements are the problem; else only purge deleted */
+        size = self->size;
+        if( 2 * (self->count + 1) * HASH_LOAD_DEN > size * HASH_LOAD_NUM )
+            size *= 2;
+        Hash_resize(self, size);
+    }
+
+    Hash_place(self, (void *)elem, h);
+    self->count++;
+    return (void *)elem;
+}
+
+void * Hash_search(const Hash_T self, const void *elem)
+{
+    if(!self || !elem)
+        return NULL;
+
+    struct Slot_T *slot = Hash_find(self, elem, self->Data_hash(elem));
+    return (slot ? slot->data : NULL);
+}
+
+bool Hash_remove(Hash_T self, const void *elem)
+{
+    if(!self || !elem)
+        return false;
+
+    unsigned h = self->Data_hash(elem), mask = self->size - 1, i = h & mask;
+
+/* Match by pointer: several elements may share the key */
+    while(self->slots[i].data)
+    {
+        if(self->slots[i].data == elem)
+        {
+            self->slots[i].data = HASH_DELETED;
+            self->count--;
+            self->deleted++;
+            return true;
+        }
+        i = (i + 1) & mask;
+    }
+    return false;
+}
+
+unsigned Hash_count(const Hash_T self)
+{
+    return self->count;
+}
+
+unsigned Hash_string(const char *str)
+{
+    unsigned h = 2166136261u; // FNV-1a offset basis
+
+    if(!str)
+        return 0;
+    while(*str)
+    {
+        h ^= (unsigned char)*str++;
+        h *= 16777619u; // FNV-1a prime
+    }
+    return h;
+}
+
+unsigned Hash_string_nocase(const char *str)
+{
+    unsigned h = 2166136261u; // FNV-1a offset basis
+
+    if(!str)
+        return 0;
+    while(*str)
+    {
+        h ^= (unsigned char)tolower((unsigned char)*str++);
+        h *= 16777619u; // FNV-1a prime
+    }
+    return h;
+}
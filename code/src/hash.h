@@ -0,0 +1,94 @@
+/**
+ * @file hash.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Interface to hash module
+ *
+ * *hash* is a generic open-addressing hash index used to find elements by a
+ * key in constant time. Like *list*, it does not own the data; it only stores
+ * pointers to it.
+ * It requires client modules to implement a hash function and a comparator
+ * over the same key: elements that compare equal must hash equal.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdbool.h>
+
+/**
+ * @brief opaque pointer to struct Hash_T.
+ * It hides the implementation details (allows modularity)
+ */
+typedef struct Hash_T *Hash_T;
+
+/**
+ * @brief Constructs a hash index
+ * @param Data_hash: a function pointer for a Data hash function
+ * @param Data_cmp: a function pointer for a Data comparator
+ * @return a constructed, empty hash index
+ */
+Hash_T Hash_ctor(unsigned (*Data_hash)(const void *data),
+                 int (*Data_cmp)(const void *data1, const void *data2));
+
+/**
+ * @brief Destructs a hash index (the data is not destroyed)
+ * @param self: a valid hash index
+ */
+void Hash_dtor(Hash_T self);
+
+/**
+ * @brief Inserts an element in the hash index
+ * @param self: a valid hash index
+ * @param elem: element to insert
+ * @param allowDups: true - duplicates allowed; false - duplicates disallowed
+ * @return data inserted; NULL if a duplicate was rejected
+ */
+void * Hash_insert(Hash_T self, const void *elem, const bool allowDups);
+
+/**
+ * @brief Search an element with the same key in the hash index
+ * @param self: a valid hash index
+ * @param elem: comparable element to perform the search
+ * @return data found; NULL otherwise
+ */
+void * Hash_search(const Hash_T self, const void *elem);
+
+/**
+ * @brief Removes an element from the hash index
+ * @param self: a valid hash index
+ * @param elem: element returned by search (matched by pointer)
+ * @return true, if removed; false, otherwise
+ *
+ * The element's key must not have changed since it was inserted;
+ * remove it before editing the key and insert it again afterwards.
+ */
+bool Hash_remove(Hash_T self, const void *elem);
+
+/**
+ * @brief Gets the nr. of elements in the hash index
+ * @param self: a valid hash index
+ * @return nr. of elements
+ */
+unsigned Hash_count(const Hash_T self);
+
+/**
+ * @brief Hashes a string
+ * @param str: a valid string
+ * @return hash value
+ *
+ * Helper for client hash functions whose comparator uses *strcmp*.
+ */
+unsigned Hash_string(const char *str);
+
+/**
+ * @brief Hashes a string (case insensitive)
+ * @param str: a valid string
+ * @return hash value
+ *
+ * Helper for client hash functions whose comparator uses *strcasecmp*.
+ */
+unsigned Hash_string_nocase(const char *str);
+
+#endif // HASH_H
@@ -10,6 +10,10 @@
 #include <stdlib.h> // malloc
 #include <assert.h> // malloc
 #include "m-utils.h" // for print_header
+#include "pool.h" // node allocation
+#include "hash.h" // hashed secondary indexes
+#include "vec.h" // ordered secondary indexes
+#include "vec-internal.h" // Vec_sort_elems
 
 #include <stdio.h> // printf
 //#define DEBUG
@@ -37,6 +41,10 @@ struct Node_T{
     void *data; /**< generic data */
     Node_T prev; /**< pointer to previous node */
     Node_T next; /**< pointer to next node */
+    Node_T left; /**< left child in the ordered index */
+    Node_T right; /**< right child in the ordered index */
+    Node_T parent; /**< parent in the ordered index */
+    int height; /**< height of the subtree rooted at node (index balance) */
 };
 
 /*          Node          Node
@@ -48,15 +56,34 @@ first -> ||||||||||    |||||||||| <- last
          ||||||||||    ||||||||||
 */
 
+/*                root
+                 |
+             ||||||||||
+             |  Node  |    The same nodes are also linked as an AVL tree
+             ||||||||||    (left/right/parent), ordered by Data_cmp.
+              /      \     In-order traversal of the tree matches the
+        ||||||||||  ||||||||||  prev/next chain, so iteration is unchanged
+        |  Node  |  |  Node  |  while insert/search/remove drop to O(log n).
+        ||||||||||  ||||||||||
+*/
+
 /**
  * @brief List's structure: generic container for doubly linked list
  *
- * detailed
+ * Besides the doubly linked chain, the nodes form a balanced (AVL) ordered 
+ * index rooted at *root*. The index is only valid (*indexed*) while the list
+ * is sorted in ascending order by the default comparator; inserting with a 
+ * different comparator or order drops the list back to linear operations
+ * until it is sorted again by the default comparator.
  */
 struct List_T{
     Node_T first; /**< Pointer to first node of the list */
     Node_T last; /**< Pointer to last node in the list */
     Node_T it; /**< Internal iterator */
+    Node_T root; /**< Root of the ordered index */
+    bool indexed; /**< true, if the ordered index is valid */
+    struct Index_T *indexes; /**< secondary indexes */
+    unsigned nr_indexes; /**< nr of secondary indexes */
     unsigned count; /**< nr of elements in the list */
     bool dirty; /**< flags that an update was made or is required */
     /* function pointers for comparing and destructor */
@@ -66,16 +93,70 @@ struct List_T{
     void (*Data_print)(const void *data); /**< pointer to data print function */
 };
 
+/**
+ * @brief Secondary index: finds elements by a key other than the list order
+ *
+ * Exactly one of *hash* and *vec* is used. Both allow duplicated keys.
+ */
+struct Index_T{
+    int (*cmp)(const void *data1, const void *data2); /**< key comparator */
+    Hash_T hash; /**< hashed index; NULL if ordered */
+    Vec_T vec; /**< ordered index; NULL if hashed */
+};
+
+/**
+ * @brief List view's structure: array of pointers to elements of a list
+ *
+ * A view references the elements, it does not own them: the elements keep
+ * belonging to the source list, which is never modified by the query.
+ */
+struct List_View_T{
+    void **elems; /**< elements, in the order of the source list */
+    unsigned count; /**< nr of elements in the view */
+    unsigned size; /**< nr of slots allocated in elems */
+    bool sorted; /**< true, if elems are sorted by the default comparator */
+    int (*Data_cmp)(const void *data1, const void *data2); /**< pointer to Data compare function */
+    void (*Data_print)(const void *data); /**< pointer to data print function */
+};
+
+/**
+ * @brief Query by comparator: context of the query predicate
+ */
+struct Query_T{
+    const void *elem; /**< comparable element */
+    int (*cmp)(const void *data1, const void *data2); /**< compare function */
+};
+
+/**
+ * @brief Query by range: context of the range predicate
+ */
+struct Range_T{
+    const void *lo; /**< lower bound (inclusive) */
+    const void *hi; /**< upper bound (exclusive) */
+    int (*cmp)(const void *data1, const void *data2); /**< compare function */
+};
+
+/**
+ * @brief Pool shared by the nodes of every list
+ *
+ * Lists are many and mostly small (one per user and per activity), so a 
+ * single pool per node type amortizes its chunks across all of them.
+ */
+static Pool_T node_pool = NULL;
+
 /**
  * @brief Allocates memory for an Node's instance
  * @return initialized memory for Node
  *
+ * Nodes are handed out by the node pool, which recycles removed nodes.
  * It is checked by assert to determine if memory was allocated.
  * If assertion is valid, returns a valid memory address
  */
 static Node_T node_new()
 {
-    Node_T node = malloc(sizeof(struct Node_T));
+    if(!node_pool)
+        node_pool = Pool_ctor(sizeof(struct Node_T));
+    Node_T node = Pool_alloc(node_pool);
     assert(node);
 #ifdef DEBUG
     printf("Node_new: %p\n", node);
@@ -93,7 +174,7 @@ static void node_delete(Node_T node)
 //    if( !node->data )
 //        return; // exit immediately
     if(node)
-        free(node);
+        Pool_free(node_pool, node);
 }
 
 /**
@@ -123,6 +204,351 @@ static bool List_isEmpty(const List_T self)
     return (self->first == NULL);
 }
 
+/*------------------------- Ordered index (AVL) --------------------------*/
+
+/**
+ * @brief Gets the height of a node in the ordered index
+ * @param node: a node or NULL
+ * @return height of the node; 0 if NULL
+ */
+static int node_height(const Node_T node)
+{
+    return (node ? node->height : 0);
+}
+
+/**
+ * @brief Recomputes the height of a node from its children
+ * @param node: a valid node
+ */
+static void node_update(Node_T node)
+{
+    int hl = node_height(node->left), hr = node_height(node->right);
+    node->height = 1 + (hl > hr ? hl : hr);
+}
+
+/**
+ * @brief Checks if the ordered index can be used for a comparator
+ * @param self: a valid list
+ * @param cmp: compare function requested by the caller (NULL for default)
+ * @return true, if the index is valid and ordered by *cmp*
+ */
+static bool List_use_index(const List_T self,
+                           int(*cmp)(const void *data1, const void *data2))
+{
+    return self->indexed && (!cmp || cmp == self->Data_cmp);
+}
+
+/**
+ * @brief Finds the secondary index of a comparator
+ * @param self: a valid list
+ * @param cmp: compare function requested by the caller
+ * @return secondary index ordered/hashed by *cmp*; NULL otherwise
+ */
+static struct Index_T * List_find_index(const List_T self,
+                        int(*cmp)(const void *data1, const void *data2))
+{
+    unsigned i;
+
+    for(i = 0; i < self->nr_indexes; i++)
+        if(self->indexes[i].cmp == cmp)
+            return &self->indexes[i];
+    return NULL;
+}
+
+/**
+ * @brief Adds an element to every secondary index
+ * @param self: a valid list
+ * @param data: element inserted in the list
+ */
+static void List_index_add(List_T self, void *data)
+{
+    unsigned i;
+
+    for(i = 0; i < self->nr_indexes; i++)
+        if(self->indexes[i].hash)
+            Hash_insert(self->indexes[i].hash, data, true);
+        else
+            Vec_insert(self->indexes[i].vec, data, true);
+}
+
+/**
+ * @brief Fills a secondary index with the elements of the list
+ * @param self: a valid list
+ * @param index: an empty secondary index of the list
+ *
+ * An ordered index is built in one go, by a single sort (@see Vec_build),
+ * instead of one insertion per element, O(n^2).
+ */
+static void List_index_build(List_T self, struct Index_T *index)
+{
+    void **elems;
+    unsigned n = 0;
+    Node_T it;
+
+    if(index->hash)
+    {
+        for(it = self->first; it; it = it->next)
+            Hash_insert(index->hash, it->data, true);
+        return;
+    }
+
+    elems = malloc((self->count ? self->count : 1) * sizeof(*elems));
+    assert(elems);
+    for(it = self->first; it; it = it->next)
+        elems[n++] = it->data;
+    Vec_build(index->vec, elems, n, true);
+    free(elems);
+}
+
+/**
+ * @brief Removes an element from every secondary index
+ * @param self: a valid list
+ * @param data: element removed from the list (with unchanged keys)
+ */
+static void List_index_remove(List_T self, void *data)
+{
+    unsigned i;
+
+    for(i = 0; i < self->nr_indexes; i++)
+        if(self->indexes[i].hash)
+            Hash_remove(self->indexes[i].hash, data);
+        else
+            Vec_remove(self->indexes[i].vec, data);
+}
+
+/**
+ * @brief Replaces an element by another one in every secondary index
+ * @param self: a valid list
+ * @param old_data: element leaving the list
+ * @param new_data: element taking its place
+ */
+static void List_index_replace(List_T self, void *old_data, void *new_data)
+{
+    if(old_data == new_data)
+        return;
+    List_index_remove(self, old_data);
+    List_index_add(self, new_data);
+}
+
+/**
+ * @brief Replaces the subtree rooted at *old* by the one rooted at *new*
+ * @param self: a valid list
+ * @param old: node to be replaced in its parent
+ * @param new: replacing node (may be NULL)
+ */
+static void tree_replace_child(List_T self, Node_T old, Node_T new)
+{
+    if(!old->parent)
+        self->root = new;
+    else if(old->parent->left == old)
+        old->parent->left = new;
+    else
+        old->parent->right = new;
+    if(new)
+        new->parent = old->parent;
+}
+
+/**
+ * @brief Rotates the subtree rooted at *x* to the left
+ * @param self: a valid list
+ * @param x: root of the subtree (must have a right child)
+ * @return new root of the subtree
+ */
+static Node_T tree_rotate_left(List_T self, Node_T x)
+{
+    Node_T y = x->right;
+
+    x->right = y->left;
+    if(y->left)
+        y->left->parent = x;
+    tree_replace_child(self, x, y);
+    y->left = x;
+    x->parent = y;
+    node_update(x);
+    node_update(y);
+    return y;
+}
+
+/**
+ * @brief Rotates the subtree rooted at *x* to the right
+ * @param self: a valid list
+ * @param x: root of the subtree (must have a left child)
+ * @return new root of the subtree
+ */
+static Node_T tree_rotate_right(List_T self, Node_T x)
+{
+    Node_T y = x->left;
+
+    x->left = y->right;
+    if(y->right)
+        y->right->parent = x;
+    tree_replace_child(self, x, y);
+    y->right = x;
+    x->parent = y;
+    node_update(x);
+    node_update(y);
+    return y;
+}
+
+/**
+ * @brief Restores the AVL balance from *node* up to the root
+ * @param self: a valid list
+ * @param node: deepest node whose subtree changed
+ */
+static void tree_rebalance(List_T self, Node_T node)
+{
+    int balance;
+
+    while(node)
+    {
+        node_update(node);
+        balance = node_height(node->left) - node_height(node->right);
+        if(balance > 1)
+        {
+            if(node_height(node->left->left) < node_height(node->left->right))
+                tree_rotate_left(self, node->left);
+            node = tree_rotate_right(self, node);
+        }
+        else if(balance < -1)
+        {
+            if(node_height(node->right->right) < node_height(node->right->left))
+                tree_rotate_right(self, node->right);
+            node = tree_rotate_left(self, node);
+        }
+        node = node->parent;
+    }
+}
+
+/**
+ * @brief Finds the node matching *elem* in the ordered index
+ * @param self: a valid (indexed) list
+ * @param elem: comparable element
+ * @param parent: if not NULL, filled with the last node visited
+ * @param cmp_last: if not NULL, filled with the last comparison made
+ * @return matching node; NULL otherwise
+ *
+ * When no match is found, *parent* and *cmp_last* tell where *elem* 
+ * would be attached: left of parent if cmp_last < 0; right otherwise.
+ */
+static Node_T tree_find(const List_T self, const void *elem,
+                        Node_T *parent, int *cmp_last)
+{
+    Node_T it = self->root, last = NULL;
+    int cmp_val = 0;
+
+    while(it)
+    {
+        last = it;
+        cmp_val = self->Data_cmp(elem, it->data);
+        if(!cmp_val)
+            break;
+        it = (cmp_val < 0) ? it->left : it->right;
+    }
+    if(parent)
+        *parent = last;
+    if(cmp_last)
+        *cmp_last = cmp_val;
+    return it;
+}
+
+/**
+ * @brief Finds the first node not less than *elem* in the ordered index
+ * @param self: a valid (indexed) list
+ * @param elem: comparable element
+ * @return first node whose data is >= elem; NULL if there is none
+ */
+static Node_T tree_lower_bound(const List_T self, const void *elem)
+{
+    Node_T it = self->root, bound = NULL;
+
+    while(it)
+    {
+        if( self->Data_cmp(it->data, elem) >= 0 )
+        {
+            bound = it; // candidate: look for a smaller one on the left
+            it = it->left;
+        }
+        else
+            it = it->right;
+    }
+    return bound;
+}
+
+/**
+ * @brief Removes a node from the ordered index (links only)
+ * @param self: a valid (indexed) list
+ * @param node: node in the index
+ *
+ * The in-order successor of a node with two children is its *next* node
+ * in the list, so no extra search is required.
+ */
+static void tree_remove(List_T self, Node_T node)
+{
+    Node_T fix, succ;
+
+    if(!node->left || !node->right)
+    {
+        fix = node->parent;
+        tree_replace_child(self, node, node->left ? node->left : node->right);
+    }
+    else
+    {
+        succ = node->next;
+        if(succ->parent != node)
+        {
+            fix = succ->parent;
+            tree_replace_child(self, succ, succ->right);
+            succ->right = node->right;
+            succ->right->parent = succ;
+        }
+        else
+            fix = succ;
+        tree_replace_child(self, node, succ);
+        succ->left = node->left;
+        succ->left->parent = succ;
+    }
+    tree_rebalance(self, fix);
+}
+
+/**
+ * @brief Builds a perfectly balanced index from consecutive list nodes
+ * @param it: pointer to the next list node to consume (updated)
+ * @param n: nr. of nodes to consume
+ * @return root of the built subtree
+ */
+static Node_T tree_build(Node_T *it, unsigned n)
+{
+    Node_T left, root;
+
+    if(!n)
+        return NULL;
+    left = tree_build(it, (n - 1) / 2);
+    root = *it;
+    *it = root->next;
+    root->left = left;
+    if(left)
+        left->parent = root;
+    root->right = tree_build(it, n - 1 - (n - 1) / 2);
+    if(root->right)
+        root->right->parent = root;
+    root->parent = NULL;
+    node_update(root);
+    return root;
+}
+
+/**
+ * @brief Rebuilds the ordered index from the list chain in O(n)
+ * @param self: a valid list, sorted by the default comparator
+ */
+static void List_reindex(List_T self)
+{
+    Node_T it = self->first;
+    self->root = tree_build(&it, self->count);
+    self->indexed = true;
+}
+
+/*------------------------------------------------------------------------*/
+
 //static bool match_data(Node_T n1, Node_T n2)
 //{
 //    return (n1->data == n2->data);
@@ -158,7 +584,10 @@ List_T List_ctor( void *(*Data_ctor)(void),
     list->Data_dtor = Data_dtor;
     list->Data_print = Data_print;
     
-    list->first = list->last = list->it = NULL;
+    list->first = list->last = list->it = list->root = NULL;
+    list->indexed = (Data_cmp != NULL); // an empty list is trivially sorted
+    list->indexes = NULL;
+    list->nr_indexes = 0;
     list->count = 0;
     list->dirty = false;
     return list;
@@ -166,8 +595,25 @@ List_T List_ctor( void *(*Data_ctor)(void),
 
 void List_dtor(List_T self)
 {
-    if(self)
-        free(self);
+    Node_T it, next;
+    unsigned i;
+
+    if(!self)
+        return;
+/* Return the nodes to the pool (data is not owned by the list) */
+    for(it = self->first; it; it = next)
+    {
+        next = it->next;
+        node_delete(it);
+    }
+/* Destroy the secondary indexes */
+    for(i = 0; i < self->nr_indexes; i++)
+    {
+        Hash_dtor(self->indexes[i].hash);
+        Vec_dtor(self->indexes[i].vec);
+    }
+    free(self->indexes);
+    free(self);
 }
 
 /* Debug version */
@@ -281,6 +727,75 @@ void List_dtor(List_T self)
 //    return node->data;
 //}
 
+/**
+ * @brief Inserts an element through the ordered index in O(log n)
+ * @param self: a valid (indexed) list
+ * @param elem: element to insert
+ * @param allowDups: true - replaces the matching element; 
+ * false - duplicates disallowed
+ * @return data inserted; NULL if a duplicate was rejected
+ *
+ * The new node is attached as a leaf of the index; its neighbours in the 
+ * list are its parent and the parent's prev/next, depending on the side.
+ */
+static void * List_insert_indexed(List_T self, const void *elem,
+                                  const bool allowDups)
+{
+    Node_T node, parent;
+    int cmp_val;
+
+/* Repeated element */
+    if( (node = tree_find(self, elem, &parent, &cmp_val)) != NULL )
+    {
+        if(!allowDups)
+            return NULL;
+        List_index_replace(self, node->data, (void *)elem);
+        node->data = (void *)elem; // update current element
+        return node->data;
+    }
+
+/* Create new leaf node with the elem data */
+    node = node_new();
+    node->data = (void *)elem;
+    node->left = node->right = NULL;
+    node->parent = parent;
+    node->height = 1;
+
+    if(!parent) // FIRST: empty list
+    {
+        node->prev = node->next = NULL;
+        self->first = self->last = self->root = node;
+    }
+    else if(cmp_val < 0) // left child: insert before parent
+    {
+        parent->left = node;
+        node->next = parent;
+        node->prev = parent->prev;
+        if(parent->prev)
+            parent->prev->next = node;
+        else // redo head
+            self->first = node;
+        parent->prev = node;
+    }
+    else // right child: insert after parent
+    {
+        parent->right = node;
+        node->prev = parent;
+        node->next = parent->next;
+        if(parent->next)
+            parent->next->prev = node;
+        else // redo tail
+            self->last = node;
+        parent->next = node;
+    }
+    tree_rebalance(self, parent);
+    List_index_add(self, node->data);
+
+    self->count++;
+    self->dirty = true; // an item was added
+    return node->data;
+}
+
 void * List_insert_ascend(List_T *self, const void *elem, 
                           const bool order, const bool allowDups,
                           int(*cmp)(const void *data1, const void *data2))
@@ -294,6 +809,10 @@ void * List_insert_ascend(List_T *self, const void *elem,
     Node_T node, *it = NULL;
     int cmp_val = 0, level = (order) ? 1 : -1;
 
+/* Ascending insert by the default comparator: use the ordered index */
+    if( order && List_use_index(*self, cmp) )
+        return List_insert_indexed(*self, elem, allowDups);
+
     // Assign compare function
    if(cmp == NULL)
        cmp = (*self)->Data_cmp;
@@ -312,9 +831,14 @@ void * List_insert_ascend(List_T *self, const void *elem,
     if( List_isEmpty(*self) ) // FIRST: insert at head
     {
        (*self)->first = (*self)->last = node;
+       List_index_add(*self, node->data);
        (*self)->dirty = true; // an item was added
+       (*self)->indexed = false; // not ordered by the default comparator
        return node->data; 
     }
+
+/* Linear insertion breaks the ordering the index relies on */
+    (*self)->indexed = false;
     //else
     while(1)
     {   // cmp_val = 0 -> equals
@@ -331,8 +855,10 @@ void * List_insert_ascend(List_T *self, const void *elem,
             if(!allowDups)
                 return NULL; // equal elems
             /* update current element */
+            List_index_replace(*self, (*it)->data, node->data);
             (*it)->data = node->data;
-            return node->data;
+            node_delete(node);
+            return (*it)->data;
         }
 
         /* Insert before */
@@ -348,6 +874,7 @@ void * List_insert_ascend(List_T *self, const void *elem,
             else // middle node inserted (redo prev->next)
                 (*it)->prev->prev->next = node;
 
+            List_index_add(*self, node->data);
             (*self)->dirty = true; // an item was added
             return node->data;
         }
@@ -365,10 +892,97 @@ void * List_insert_ascend(List_T *self, const void *elem,
     (*it)->next->prev = *it;
     (*self)->last = node; 
 
+    List_index_add(*self, node->data);
     (*self)->dirty = true; // an item was added
     return node->data;
 }
 
+unsigned List_build(List_T *self, void **elems, unsigned n)
+{
+    if( !(*self) || !elems )
+        return 0;
+
+    void **rejected;
+    unsigned i, kept = 0, nr_rej = 0;
+    bool sorted = true;
+    Node_T node;
+
+    rejected = malloc((n ? n : 1) * sizeof(*rejected));
+    assert(rejected);
+
+/* Not empty or not ordered by the default cmp: insert one at a time */
+    if( !List_isEmpty(*self) || !List_use_index(*self, NULL) )
+    {
+        for(i = 0; i < n; i++)
+            if( List_insert_ascend(self, elems[i], true, false, NULL) )
+                elems[kept++] = elems[i];
+            else
+                rejected[nr_rej++] = elems[i];
+    }
+    else
+    {
+/* Records written in order need no sorting: one linear check */
+        for(i = 1; i < n && sorted; i++)
+            sorted = ( (*self)->Data_cmp(elems[i - 1], elems[i]) < 0 );
+        if(!sorted)
+            Vec_sort_elems(elems, rejected, n, (*self)->Data_cmp);
+/* Keep the first of each run of duplicates (sort is stable) */
+        for(i = 0; i < n; i++)
+            if( !sorted && kept &&
+                !(*self)->Data_cmp(elems[kept - 1], elems[i]) )
+                rejected[nr_rej++] = elems[i];
+            else
+                elems[kept++] = elems[i];
+/* Append in order and build the index in one go */
+        for(i = 0; i < kept; i++)
+        {
+            node = node_new();
+            node->data = elems[i];
+            node->next = NULL;
+            node->prev = (*self)->last;
+            if( (*self)->last )
+                (*self)->last->next = node;
+            else
+                (*self)->first = node;
+            (*self)->last = node;
+        }
+        (*self)->count = kept;
+        for(i = 0; i < (*self)->nr_indexes; i++)
+            List_index_build(*self, &(*self)->indexes[i]);
+        List_reindex(*self);
+        if(kept)
+            (*self)->dirty = true; // items were added
+    }
+
+/* Duplicates are handed back at the end of elems */
+    for(i = 0; i < nr_rej; i++)
+        elems[kept + i] = rejected[i];
+    free(rejected);
+    return kept;
+}
+
+bool List_add_index(List_T self,
+                    int(*cmp)(const void *data1, const void *data2),
+                    unsigned (*hash)(const void *data))
+{
+    if(!self || !cmp || List_find_index(self, cmp))
+        return false;
+
+    struct Index_T *index;
+
+    self->indexes = realloc(self->indexes,
+                            (self->nr_indexes + 1) * sizeof(*self->indexes));
+    assert(self->indexes);
+    index = &self->indexes[self->nr_indexes++];
+    index->cmp = cmp;
+    index->hash = (hash ? Hash_ctor(hash, cmp) : NULL);
+    index->vec = (hash ? NULL : Vec_ctor(NULL, cmp, NULL, NULL));
+
+/* Index the elements already in the list */
+    List_index_build(self, index);
+    return true;
+}
+
 void * List_search(const List_T self, const void *elem, 
                    int(*cmp)(const void *data1, const void *data2))
 {
@@ -379,28 +993,29 @@ void * List_search(const List_T self, const void *elem,
     if( List_isEmpty(self) )
         return NULL;
 
+/* Search by a secondary index */
+    struct Index_T *index = List_find_index(self, cmp ? cmp : self->Data_cmp);
+    if(index)
+        return (index->hash ? Hash_search(index->hash, elem) :
+                              Vec_search(index->vec, elem, NULL) );
+
+/* Search by the default comparator: use the ordered index */
+    if( List_use_index(self, cmp) )
+    {
+        Node_T node = tree_find(self, elem, NULL, NULL);
+        return (node ? node->data : NULL);
+    }
+
    // Initialize iterator to 1st elem of the list
-    Node_T it = self->first;
-    int cmp_val;
+    Node_T it;
     
    if(!cmp)
        cmp = self->Data_cmp;
 
-   while(1)
-   {
-       cmp_val = cmp( elem, it->data ) ;
-/* Match found */
-       if(!cmp_val) 
+/* The list is not sorted by cmp: no early exit, scan all */
+   for(it = self->first; it; it = it->next)
+       if( !cmp(elem, it->data) )
            return (it->data);
-/* Array is sorted; exceeded rank */
-       if(cmp_val < 0) 
-           return NULL;
-/* Break */
-       if(! it->next)
-           break;
-/* Iterate */
-       it = it->next;
-   }
   return NULL; 
 }
 
@@ -418,48 +1033,233 @@ List_T List_search_all(const List_T self, const void *elem,
     if( List_isEmpty(self) )
         return NULL;
 
-/* Construct a new list */
+/* Collect the matches in one pass */
+    List_View_T view = List_query(self, elem, cmp);
+
+/* Construct a new list and load it in one go (matches are in source order) */
     List_T dest = List_ctor(self->Data_ctor, self->Data_cmp,
                             self->Data_dtor, self->Data_print);
+    List_build(&dest, view->elems, view->count);
+    List_View_dtor(view);
 
-/* Update compare function */
-    if( cmp )
+/* Update compare function: the index is only valid for the default one */
+    if( cmp && cmp != self->Data_cmp )
+    {
         dest->Data_cmp = cmp;
+        dest->indexed = false;
+    }
 
-    void *data; // elem found in the list
+/* Return list */
+    return dest;
+}
 
-/* Store initial position of the original list */
-    Node_T it, head;
-    it = head = self->first;
-    
-/* Search similar elems in original list and insert them in destination list*/
-    while(it)
+/**
+ * @brief Allocates memory for an List view's instance
+ * @param self: source list
+ * @return initialized memory for List view, with no elements
+ *
+ * It is checked by assert to determine if memory was allocated.
+ * If assertion is valid, returns a valid memory address
+ */
+static List_View_T List_View_new(const List_T self)
+{
+    List_View_T view = malloc(sizeof(*view));
+    assert(view);
+    view->elems = NULL;
+    view->count = view->size = 0;
+    view->sorted = self->indexed;
+    view->Data_cmp = self->Data_cmp;
+    view->Data_print = self->Data_print;
+    return view;
+}
+
+/**
+ * @brief Appends an element to the view, growing it geometrically
+ * @param view: a valid view
+ * @param data: element to append
+ */
+static void List_View_append(List_View_T view, void *data)
+{
+    if(view->count == view->size)
     {
-        /* Update head for search */
-        self->first = it;
+        view->size = (view->size ? 2 * view->size : 16);
+        view->elems = realloc(view->elems, view->size * sizeof(*view->elems));
+        assert(view->elems);
+    }
+    view->elems[view->count++] = data;
+}
 
-        /* Search elem in the original list with the new compare function */
-        data = List_search(self, elem, cmp);
+/**
+ * @brief Query predicate: element matches the query element
+ * @param data: element of the list
+ * @param ctx: query (struct Query_T)
+ * @return true, if cmp(elem, data) is 0
+ */
+static bool query_match(const void *data, const void *ctx)
+{
+    const struct Query_T *query = ctx;
+    return !query->cmp(query->elem, data);
+}
 
-//#ifdef DEBUG
-//        printf("\n------- Search all------\n");
-//        List_print_elem(self, it->data);
-//        List_print_elem(self, data);
-//        getchar();
-//#endif
+List_View_T List_filter(const List_T self,
+                        bool (*pred)(const void *data, const void *ctx),
+                        const void *ctx)
+{
+    if(!self || !pred)
+        return NULL;
+
+    List_View_T view = List_View_new(self);
+    Node_T it;
+
+/* Single pass: the source list is only read */
+    for(it = self->first; it; it = it->next)
+        if( pred(it->data, ctx) )
+            List_View_append(view, it->data);
+    return view;
+}
+
+List_View_T List_query(const List_T self, const void *elem,
+                       int(*cmp)(const void *data1, const void *data2))
+{
+    if(!self || !elem)
+        return NULL;
+
+    struct Query_T query = { elem, (cmp ? cmp : self->Data_cmp) };
+    List_View_T view;
+    Node_T node;
+
+    if(!query.cmp)
+        return NULL;
+/* Any comparator but the default one: filter the whole list */
+    if( !List_use_index(self, cmp) )
+        return List_filter(self, query_match, &query);
+
+/* Default comparator: matches are adjacent to the one found in the index */
+    view = List_View_new(self);
+    node = tree_find(self, elem, NULL, NULL);
+    if(!node)
+        return view;
+    while(node->prev && query_match(node->prev->data, &query))
+        node = node->prev;
+    for( ; node && query_match(node->data, &query); node = node->next)
+        List_View_append(view, node->data);
+    return view;
+}
+
+/**
+ * @brief Range predicate: element is in [lo, hi)
+ * @param data: element of the list
+ * @param ctx: range (struct Range_T)
+ * @return true, if lo <= data < hi
+ */
+static bool range_match(const void *data, const void *ctx)
+{
+    const struct Range_T *range = ctx;
+    return range->cmp(data, range->lo) >= 0 && range->cmp(data, range->hi) < 0;
+}
+
+List_View_T List_search_range(const List_T self, const void *lo,
+                              const void *hi)
+{
+    if(!self || !lo || !hi || !self->Data_cmp)
+        return NULL;
+
+    struct Range_T range = { lo, hi, self->Data_cmp };
+    List_View_T view;
+    Node_T it;
 
-        /* Insert the elem in the dest list with the default cmp function */
-        List_insert_ascend( &dest, data, true, false, self->Data_cmp);
+/* Not sorted by the default comparator: filter the whole list */
+    if( !List_use_index(self, NULL) )
+        return List_filter(self, range_match, &range);
 
-        /* Iterate */
-        it = it->next;
+/* Sorted: seek the lower bound, then walk until the upper bound */
+    view = List_View_new(self);
+    for(it = tree_lower_bound(self, lo);
+        it && self->Data_cmp(it->data, hi) < 0; it = it->next)
+        List_View_append(view, it->data);
+    return view;
+}
+
+unsigned List_View_count(const List_View_T view)
+{
+    return (view ? view->count : 0);
+}
+
+void * List_View_get(const List_View_T view, unsigned idx)
+{
+    if(!view || idx >= view->count)
+        return NULL;
+    return view->elems[idx];
+}
+
+void * List_View_search(const List_View_T view, const void *elem,
+                        int(*cmp)(const void *data1, const void *data2))
+{
+    if(!view || !elem)
+        return NULL;
+
+    unsigned lo = 0, hi = view->count, mid;
+    int cmp_val;
+
+/* Sorted by the requested comparator: binary search */
+    if( view->sorted && (!cmp || cmp == view->Data_cmp) )
+    {
+        while(lo < hi)
+        {
+            mid = lo + (hi - lo) / 2;
+            cmp_val = view->Data_cmp(elem, view->elems[mid]);
+            if(!cmp_val)
+                return view->elems[mid];
+            if(cmp_val < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return NULL;
     }
 
-    /* Restore original list head */
-    self->first = head;
+/* Otherwise, linear search */
+    if(!cmp)
+        cmp = view->Data_cmp;
+    for(lo = 0; lo < view->count; lo++)
+        if( !cmp(elem, view->elems[lo]) )
+            return view->elems[lo];
+    return NULL;
+}
 
-/* Return list */
-    return dest;
+void List_View_print_all(const List_View_T view,
+                         void(*print)(const void *data), bool numbered,
+                         const char *header)
+{
+    if(!view)
+        return;
+
+    if(!print)
+        print = view->Data_print;
+
+    unsigned i;
+
+/* Print size */
+    printf("\n\t\tTotal de elementos: %u\n\n", view->count);
+/* Print header */
+    if(header)
+        print_header(header);
+    for(i = 0; i < view->count; i++)
+    {
+/* Print numbering */
+        if(numbered)
+            printf("%.2d, ", i + 1);
+/* Print data */
+        print(view->elems[i]);
+    }
+}
+
+void List_View_dtor(List_View_T view)
+{
+    if(!view)
+        return;
+    free(view->elems);
+    free(view);
 }
 
 bool List_remove(List_T *self, const void *elem)
@@ -471,8 +1271,7 @@ bool List_remove(List_T *self, const void *elem)
     if(!(*self)->Data_dtor)
         return false;
 
-   // Initialize iterator to 1st elem of the list
-    Node_T *it = &( (*self)->first ); 
+    Node_T node = NULL, it;
 
     /* Empty list, return immediately */
     if( List_isEmpty(*self) )
@@ -481,49 +1280,92 @@ bool List_remove(List_T *self, const void *elem)
        return false; 
     }
 
-   while(1)
-   {
+/* Locate the node through the index; the data must match by pointer */
+    if( (*self)->indexed )
+    {
+        node = tree_find(*self, elem, NULL, NULL);
+        if(node && node->data != elem)
+            node = NULL;
+    }
+/* Fallback: linear scan by pointer (e.g., key was edited in place) */
+    for(it = (*self)->first; !node && it; it = it->next)
+        if( elem == it->data )
+            node = it;
+    if(!node)
+        return false;
+
 #ifdef DEBUG
-       printf("\nElem: %p\n", elem);
-       Node_print(*it);
-       (*self)->Data_print((*it)->data);
-       getchar();
+    printf("\nElem: %p\n", elem);
+    Node_print(node);
+    (*self)->Data_print(node->data);
+    getchar();
 #endif
-       // data match
-       if( elem == (*it)->data )
-       {/* redo links */
-           if( (*it)->next )
-               (*it)->next->prev = (*it)->prev;
-           else // redo tail
-               (*self)->last = (*it)->prev;
-           if( (*it)->prev )
-               (*it)->prev->next = (*it)->next;
-           else // redo head
-               (*self)->first = (*it)->next;
-
-           /* Destroy data, delete node and update count*/
-           //(*self)->Data_dtor( (*it)->data );
-//           node_delete(*it);
-           (*self)->count--;
+/* redo index links */
+    if( (*self)->indexed )
+        tree_remove(*self, node);
+    List_index_remove(*self, node->data);
+/* redo list links */
+    if( node->next )
+        node->next->prev = node->prev;
+    else // redo tail
+        (*self)->last = node->prev;
+    if( node->prev )
+        node->prev->next = node->next;
+    else // redo head
+        (*self)->first = node->next;
+
+    /* Keep the internal iterator valid */
+    if( (*self)->it == node )
+        (*self)->it = node->next;
+
+    /* Destroy data, delete node and update count*/
+    //(*self)->Data_dtor( node->data );
+    node_delete(node);
+    (*self)->count--;
+
+    /* empty List; destroy it */
+    if(! (*self)->count)
+    {
+        (*self)->first = (*self)->last = (*self)->root = NULL;
+        (*self)->indexed = ((*self)->Data_cmp != NULL); // trivially sorted
+//        List_dtor( *self );
+    }
 
-           /* empty List; destroy it */
-           if(! (*self)->count)
-           {
-               (*self)->first = (*self)->last = NULL;
-//               List_dtor( *self );
-           }
+    (*self)->dirty = true; // an item was removed
+    return true;
+}
 
-           (*self)->dirty = true; // an item was removed
-           return true;
-       }
-/* Break */
-       if(! (*it)->next)
-           break;
+void List_iter_init(List_Iter_T *iter, const List_T self)
+{
+    if(!iter)
+        return;
+    iter->list = self;
+    iter->node = (self ? self->first : NULL);
+}
 
-/* Iterate */
-       it = &((*it)->next);
-   }
-  return false; 
+void * List_iter_next(List_Iter_T *iter)
+{
+    if(!iter || !iter->node)
+        return NULL;
+
+    void *data = iter->node->data;
+/* Iterate before returning: the element can be removed by the caller */
+    iter->node = iter->node->next;
+    return data;
+}
+
+void List_foreach(const List_T self, void (*fcn)(void *data, void *ctx),
+                  void *ctx)
+{
+    if(!self || !fcn)
+        return;
+
+    List_Iter_T iter;
+    void *data;
+
+    List_iter_init(&iter, self);
+    while( (data = List_iter_next(&iter)) != NULL )
+        fcn(data, ctx);
 }
 
 void * List_pop(List_T self)
@@ -547,6 +1389,37 @@ void List_rewind(List_T self)
     self->it = self->first;
 }
 
+/**
+ * @brief Merges two sorted chains of nodes (linked by *next* only)
+ * @param a: first chain (earlier elements: wins ties, keeping stability)
+ * @param b: second chain
+ * @param cmp: compare function
+ * @return head of the merged chain
+ */
+static Node_T List_merge(Node_T a, Node_T b,
+                         int(*cmp)(const void *data1, const void *data2))
+{
+    struct Node_T head;
+    Node_T tail = &head;
+
+    while(a && b)
+    {
+        if( cmp(a->data, b->data) <= 0 )
+        {
+            tail->next = a;
+            a = a->next;
+        }
+        else
+        {
+            tail->next = b;
+            b = b->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = a ? a : b;
+    return head.next;
+}
+
 void List_sort(List_T *self, 
                int(*cmp)(const void *data1, const void *data2))
 {
@@ -561,69 +1434,38 @@ void List_sort(List_T *self,
    if( !cmp )
        cmp = (*self)->Data_cmp;
 
-   Node_T prev, next, next_next, *it = NULL;
-   int cmp_val;
-   
-#ifdef DEBUG
-   printf("Sort - Self: %p", self);
-   getchar();
-#endif
-   
-   // Initialize iterator to 1st elem of the list
-   it = &(*self)->first;
+/* Bottom-up merge sort: bin[i] holds a sorted run of 2^i nodes (or NULL).
+   Nodes are added one at a time and carried up like a binary counter. */
+   Node_T bin[sizeof(unsigned) * 8 + 1] = {NULL};
+   Node_T it, next, carry, prev;
+   unsigned i, nr_bins = 0;
 
-   while(1)
+   for(it = (*self)->first; it; it = next)
    {
-/* Break */
-       if(! (*it)->next)
-           break;
-
-       cmp_val = cmp((*it)->data, (*it)->next->data);
-#ifdef DEBUG
-       printf("cmp_val: %d\n", cmp_val);
-       (*self)->Data_print((*it)->data);
-       (*self)->Data_print((*it)->next->data);
-       getchar();
-#endif
-       
-       /* Sort */
-       if(cmp_val > 0) // cur > next --> swap nodes
+       next = it->next;
+       it->next = NULL;
+       carry = it;
+       /* Older runs go first so equal elements keep their order */
+       for(i = 0; bin[i]; i++)
        {
-/* Store links */
-           prev = (*it)->prev;
-           next = (*it);
-           next_next = (*it)->next->next;
-#ifdef DEBUG
-           printf("Prev: %p\t Next: %p\n", prev, next);
-#endif
-/* Swap pointers */
-           (*it) = (*it)->next;
-#ifdef DEBUG
-           printf("It: %p\n", (*it));
-#endif
-/* Update Links */
-           (*it)->prev = prev;
-           (*it)->next = next;
-#ifdef DEBUG
-           printf("Prev: %p\t Next: %p\n", (*it)->prev, (*it)->next);
-#endif
-           (*it)->next->next = next_next;
-           (*it)->next->prev = (*it);
-#ifdef DEBUG
-           printf("Next->next: %p\t Next->prev: %p\n", (*it)->next->next, (*it)->next->prev);
-
-#endif
-           if( (*it)->prev )
-               (*it)->prev->next = (*it);
-           else // Update Head
-               (*self)->first = (*it);
-           if( !(*it)->next->next ) // update tail
-               (*self)->last = (*it)->next;
+           carry = List_merge(bin[i], carry, cmp);
+           bin[i] = NULL;
        }
-
-/* Iterate */
-       it = &((*it)->next);
+       bin[i] = carry;
+       if(i >= nr_bins)
+           nr_bins = i + 1;
    }
+/* Merge the remaining runs, from the newest (lowest) to the oldest */
+   for(carry = NULL, i = 0; i < nr_bins; i++)
+       if(bin[i])
+           carry = List_merge(bin[i], carry, cmp);
+
+/* Redo prev links, head and tail; rewind the internal iterator */
+   (*self)->first = carry;
+   for(prev = NULL, it = carry; it; prev = it, it = it->next)
+       it->prev = prev;
+   (*self)->last = prev;
+   (*self)->it = (*self)->first;
 
 #ifdef DEBUG
        printf("Sort: First & Last\n");
@@ -631,7 +1473,12 @@ void List_sort(List_T *self,
        (*self)->Data_print((*self)->last->data);
        getchar();
 #endif
-    
+
+/* Nodes were relinked: rebuild the index if sorted by the default cmp */
+    if( cmp == (*self)->Data_cmp )
+        List_reindex(*self);
+    else
+        (*self)->indexed = false;
 }
 
 bool List_replace(List_T *self, const void *new_elem, const void *old_elem)
@@ -659,6 +1506,10 @@ bool List_replace(List_T *self, const void *new_elem, const void *old_elem)
        /* data ptrs are equal */
        if( old_elem == (*it)->data)
        {
+           /* A different key invalidates the node's position in the index */
+           if( (*self)->indexed && (*self)->Data_cmp(new_elem, old_elem) )
+               (*self)->indexed = false;
+           List_index_replace(*self, (*it)->data, (void *)new_elem);
            (*it)->data = (void *)new_elem;
            return true;
        }
@@ -751,6 +1602,16 @@ void List_print_elem(const List_T self, const void *elem,
     print( elem );
 }
 
+void List_get_pool_stats(Pool_Stats_T *stats)
+{
+    if(!stats)
+        return;
+    if(node_pool)
+        Pool_get_stats(node_pool, stats);
+    else
+        *stats = (Pool_Stats_T){0};
+}
+
 bool List_isDirty(const List_T self)
 {
     return self->dirty;
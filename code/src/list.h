@@ -11,12 +11,17 @@
  * *deletion*, *search* and *sort*.
  * Thus, it requires client modules to implement the desired functions
  * like the comparators and printers that can be applied over the container.
+ *
+ * The list keeps a balanced ordered index over its nodes, so insertion, 
+ * search and removal by the default comparator are O(log n); using any
+ * other comparator falls back to a linear traversal.
  */
 
 #ifndef LIST_H
 #define LIST_H
 
 #include <stdbool.h>
+#include "pool.h"
 
 /**
  * @brief opaque pointer to struct List_T. 
@@ -24,6 +29,26 @@
  */
 typedef struct List_T *List_T;
 
+/**
+ * @brief opaque pointer to struct List_View_T. 
+ * A view is a lightweight array of pointers to elements of a list; it 
+ * does not own the elements, so it must not outlive them.
+ */
+typedef struct List_View_T *List_View_T;
+
+/**
+ * @brief External iterator of a list
+ *
+ * Declared by the caller (usually on the stack) and set up by List_iter_init;
+ * it only reads the list, so any nr. of iterators can traverse the same list
+ * at once. It already points past the element it returned, so that element
+ * may be removed from the list during the traversal.
+ */
+typedef struct List_Iter_T{
+    const struct List_T *list; /**< list being traversed */
+    const struct Node_T *node; /**< next node to visit; NULL at the end */
+} List_Iter_T;
+
 /**
  * @brief Constructs an list
  * @param Data_ctor: a function pointer for a Data constructor
@@ -58,6 +83,40 @@ void * List_insert_ascend(List_T *self, const void *elem,
                           const bool order, const bool allowDups,
                           int(*cmp)(const void *data1, const void *data2));
 
+/**
+ * @brief Inserts a batch of elements in ascending order by the default 
+ * compare function
+ * @param self: a pointer to valid list
+ * @param elems: array of elements to insert; it is reordered
+ * @param n: nr. of elements
+ * @return nr. of elements inserted
+ *
+ * Used to load a list in one go: if the list is empty, already sorted input
+ * is appended in O(n), otherwise it is sorted in O(n log n) first.
+ * Duplicates are not inserted (the first occurrence is kept); on return,
+ * elems holds the inserted elements followed by the rejected ones, so the
+ * caller can destroy the latter.
+ */
+unsigned List_build(List_T *self, void **elems, unsigned n);
+
+/**
+ * @brief Adds a secondary index to the list
+ * @param self: a valid list
+ * @param cmp: compare function of the key to index
+ * @param hash: hash function of the same key; if NULL the index is ordered
+ * @return true, if added; false, if invalid or *cmp* is already indexed
+ *
+ * Searches by *cmp* use the index: O(1) if hashed, O(log n) if ordered.
+ * The index is kept up to date on insert, remove and replace, so the key
+ * of an element must not be modified while it is in the list: remove it,
+ * modify it and insert it again.
+ * The compare and hash functions must be implemented by the client module;
+ * elements that compare equal must hash equal.
+ */
+bool List_add_index(List_T self,
+                    int(*cmp)(const void *data1, const void *data2),
+                    unsigned (*hash)(const void *data));
+
 /**
  * @brief Search a similar element in the list
  * @param self: a valid list
@@ -65,7 +124,9 @@ void * List_insert_ascend(List_T *self, const void *elem,
  * @param cmp: compare function to be used in the insertion; if NULL it uses the default compare function
  * @return data found; NULL otherwise
  *
- * The compare functions must be implemented by the client module
+ * The compare functions must be implemented by the client module.
+ * Searches use a secondary index of *cmp*, if any, or the ordered index
+ * of the default compare function; otherwise the whole list is scanned.
  */
 void * List_search(const List_T self, const void *elem, 
                    int(*cmp)(const void *data1, const void *data2));
@@ -77,11 +138,102 @@ void * List_search(const List_T self, const void *elem,
  * @param cmp: compare function to be used in the insertion; if NULL it uses the default compare function
  * @return list of elements; NULL otherwise
  *
- * The compare functions must be implemented by the client module
+ * The compare functions must be implemented by the client module.
+ * The returned list is a copy; prefer List_query when a view is enough.
  */
 List_T List_search_all(const List_T self, const void *elem,
                        int(*cmp)(const void *data1, const void *data2));
 
+/**
+ * @brief Selects the elements of the list that satisfy a predicate
+ * @param self: a valid list
+ * @param pred: predicate called with each element and *ctx*
+ * @param ctx: user context passed to the predicate; may be NULL
+ * @return view of the matching elements, in list order; NULL otherwise
+ *
+ * Built in a single pass, O(n), without modifying the list.
+ * The view must be destructed with List_View_dtor.
+ */
+List_View_T List_filter(const List_T self,
+                        bool (*pred)(const void *data, const void *ctx),
+                        const void *ctx);
+
+/**
+ * @brief Selects the elements of the list matching /elem/
+ * @param self: a valid list
+ * @param elem: comparable element to perform the search
+ * @param cmp: compare function to be used in the search; if NULL it uses the default compare function
+ * @return view of the matching elements, in list order; NULL otherwise
+ *
+ * The compare functions must be implemented by the client module.
+ * O(n) in a single pass; O(log n + k) with the default compare function.
+ * The view must be destructed with List_View_dtor.
+ */
+List_View_T List_query(const List_T self, const void *elem,
+                       int(*cmp)(const void *data1, const void *data2));
+
+/**
+ * @brief Selects the elements of the list in the range [lo, hi)
+ * @param self: a valid list
+ * @param lo: comparable element; lower bound (inclusive)
+ * @param hi: comparable element; upper bound (exclusive)
+ * @return view of the elements in range, in list order; NULL otherwise
+ *
+ * The range is defined by the default compare function.
+ * O(log n + k) through the ordered index; O(n) if the list is not sorted
+ * by the default compare function.
+ * The view must be destructed with List_View_dtor.
+ */
+List_View_T List_search_range(const List_T self, const void *lo,
+                              const void *hi);
+
+/**
+ * @brief Gets the nr. of elements in the view
+ * @param view: a valid view
+ * @return nr. of elements in the view
+ */
+unsigned List_View_count(const List_View_T view);
+
+/**
+ * @brief Gets an element of the view by position
+ * @param view: a valid view
+ * @param idx: position, starting at 0
+ * @return element; NULL if out of range
+ */
+void * List_View_get(const List_View_T view, unsigned idx);
+
+/**
+ * @brief Search a similar element in the view
+ * @param view: a valid view
+ * @param elem: comparable element to perform the search
+ * @param cmp: compare function to be used in the search; if NULL it uses the default compare function
+ * @return data found; NULL otherwise
+ *
+ * Binary search with the default compare function, if the source list was
+ * sorted by it; linear search otherwise.
+ */
+void * List_View_search(const List_View_T view, const void *elem,
+                        int(*cmp)(const void *data1, const void *data2));
+
+/**
+ * @brief Prints all elements in the view
+ * @param view: a valid view
+ * @param print: pointer to function print; if NULL it uses the list's one
+ * @param numbered: true - prints the elements with numbering
+ * @param header: header; used for tabled
+ *
+ * @see List_print_all
+ */
+void List_View_print_all(const List_View_T view,
+                         void(*print)(const void *data), bool numbered,
+                         const char *header);
+
+/**
+ * @brief Destructs a view; the elements are left untouched
+ * @param view: a valid view or NULL
+ */
+void List_View_dtor(List_View_T view);
+
 /**
  * @brief Removes element in the list returned by search
  * @param self: a pointer to valid list
@@ -109,7 +261,9 @@ bool List_replace(List_T *self, const void *old_elem, const void *new_elem);
  * @param cmp: compare function to be used in the insertion; if NULL it uses the default compare function
  *
  * The compare functions must be implemented by the client module;
- * It is required when sorting key is updated in the list
+ * It is required when sorting key is updated in the list.
+ * It is a stable merge sort, O(n log n), done by relinking the nodes in place;
+ * the internal iterator is rewound.
  */
 void List_sort(List_T *self, 
                int(*cmp)(const void *data1, const void *data2));
@@ -159,6 +313,16 @@ void List_debug(const List_T self);
 void List_print_elem(const List_T self, const void *elem,
                      void(*print)(const void *data) );
 
+/**
+ * @brief Gets the allocation statistics of the list nodes
+ * @param stats: statistics to be filled in
+ *
+ * Nodes of every list are allocated from a single pool, so the statistics
+ * cover all lists.
+ * @see pool.h
+ */
+void List_get_pool_stats(Pool_Stats_T *stats);
+
 /**
  * @brief Checks if list is *dirty*, i.e., if it was updated or requires an update
  * @param self: a valid list
@@ -174,10 +338,39 @@ bool List_isDirty(const List_T self);
  */
 void List_set_dirty(List_T self, const bool dirty);
 
+/**
+ * @brief Initializes an external iterator at the head of the list
+ * @param iter: iterator to initialize
+ * @param self: a valid list
+ */
+void List_iter_init(List_Iter_T *iter, const List_T self);
+
+/**
+ * @brief Gets the next element of a traversal
+ * @param iter: an initialized iterator
+ * @return next element of the list; NULL at the end
+ */
+void * List_iter_next(List_Iter_T *iter);
+
+/**
+ * @brief Calls a function for every element in the list, in order
+ * @param self: a valid list
+ * @param fcn: function called with each element and *ctx*
+ * @param ctx: user context passed to the function; may be NULL
+ *
+ * The list is not modified, so it can be traversed by several 
+ * consumers at the same time.
+ */
+void List_foreach(const List_T self, void (*fcn)(void *data, void *ctx),
+                  void *ctx);
+
 /**
  * @brief Pops an element from the head of the list
  * @param self: a valid list
  * @return element of the list; NULL if empty
+ *
+ * Advances the internal iterator, so only one traversal can be made at a
+ * time; prefer an external iterator (List_iter_init).
  */
 void * List_pop(List_T self);
 
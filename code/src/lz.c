@@ -0,0 +1,250 @@
+/**
+ * @file lz.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief lz's module implementation
+ */
+
+#include "lz.h"
+#include <stdint.h>
+#include <string.h> // memcpy, memset
+
+/* Block format: sequences of
+|||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+| token | [lit. len.] | literals | offset (2B) | [match len.] |
+|||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+token: high nibble - nr. of literals; low nibble - match length - 4.
+A nibble of 15 is extended by the following bytes, added up until one is
+not 255. The last sequence has literals only: the block ends after them.
+*/
+
+#define LZ_MIN_MATCH 4 /**< Min. length of a match */
+#define LZ_MAX_OFFSET 65535 /**< Max. distance of a match */
+#define LZ_HASH_BITS 14 /**< log2 of the nr. of entries of the hash table */
+#define LZ_SKIP_TRIGGER 6 /**< log2 of the misses before the step grows */
+
+typedef unsigned char byte; /**< atomic unit of data */
+
+/**
+ * @brief Loads 4 bytes (unaligned)
+ * @param p: source
+ * @return value
+ */
+static uint32_t LZ_read32(const byte *p)
+{
+    uint32_t val;
+    memcpy(&val, p, sizeof(val));
+    return val;
+}
+
+/**
+ * @brief Hashes 4 bytes to an entry of the hash table
+ * @param seq: 4 bytes
+ * @return entry
+ */
+static unsigned LZ_hash(uint32_t seq)
+{
+    return (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/**
+ * @brief Length of the common prefix of two byte strings
+ * @param a: first string
+ * @param b: second string (b > a)
+ * @param end: end of b
+ * @return nr. of equal bytes
+ */
+static size_t LZ_count(const byte *a, const byte *b, const byte *end)
+{
+    const byte *start = b;
+    uint64_t x, y;
+
+/* 8 bytes at a time: the first different byte is found from the xor */
+    while(b + 8 <= end)
+    {
+        memcpy(&x, a, 8);
+        memcpy(&y, b, 8);
+        if(x != y)
+        {
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return (b - start) + (__builtin_ctzll(x ^ y) >> 3);
+#else
+            break;
+#endif
+        }
+        a += 8;
+        b += 8;
+    }
+    while(b < end && *a == *b)
+    {
+        a++;
+        b++;
+    }
+    return b - start;
+}
+
+/**
+ * @brief Writes a length extension (bytes of 255, then the remainder)
+ * @param op: destination
+ * @param len: length beyond 15
+ * @return end of the extension
+ */
+static byte * LZ_write_len(byte *op, size_t len)
+{
+    for(; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = (byte)len;
+    return op;
+}
+
+/**
+ * @brief Writes a sequence
+ * @param op: destination
+ * @param oend: end of destination
+ * @param lit: literals
+ * @param nr_lit: nr. of literals
+ * @param offset: distance of the match; 0 for the last sequence
+ * @param mlen: length of the match
+ * @return end of the sequence; NULL if it does not fit
+ */
+static byte * LZ_write_seq(byte *op, const byte *oend, const byte *lit,
+                           size_t nr_lit, size_t offset, size_t mlen)
+{
+    byte *token = op;
+
+/* Worst case: token, extensions, literals and offset */
+    if( (size_t)(oend - op) < 1 + nr_lit / 255 + 1 + nr_lit + 2 +
+        mlen / 255 + 1 )
+        return NULL;
+
+    op++;
+    *token = (byte)((nr_lit < 15 ? nr_lit : 15) << 4);
+    if(nr_lit >= 15)
+        op = LZ_write_len(op, nr_lit - 15);
+    memcpy(op, lit, nr_lit);
+    op += nr_lit;
+    if(!offset)
+        return op; // last sequence
+
+    *op++ = (byte)offset;
+    *op++ = (byte)(offset >> 8);
+    mlen -= LZ_MIN_MATCH;
+    *token |= (byte)(mlen < 15 ? mlen : 15);
+    if(mlen >= 15)
+        op = LZ_write_len(op, mlen - 15);
+    return op;
+}
+
+size_t LZ_bound(size_t n)
+{
+    return n + n / 255 + 16;
+}
+
+size_t LZ_compress(const void *src, size_t n, void *dst, size_t cap)
+{
+    const byte *in = src, *ip = in, *anchor = in, *end = in + n, *ref;
+    byte *op = dst, *oend = op + cap;
+    uint32_t table[1 << LZ_HASH_BITS]; // positions of the last 4-byte seqs
+    uint32_t seq;
+    unsigned h, misses = 0;
+    size_t mlen, step;
+
+    if(!src || !dst)
+        return 0;
+    memset(table, 0, sizeof(table));
+
+/* Greedy parse: take the match at the hashed position, if any */
+    while(ip + LZ_MIN_MATCH <= end)
+    {
+        seq = LZ_read32(ip);
+        h = LZ_hash(seq);
+        ref = in + table[h];
+        table[h] = ip - in;
+        if(ref < ip && ip - ref <= LZ_MAX_OFFSET && LZ_read32(ref) == seq)
+        {
+            mlen = LZ_MIN_MATCH + LZ_count(ref + LZ_MIN_MATCH,
+                                           ip + LZ_MIN_MATCH, end);
+            if( !(op = LZ_write_seq(op, oend, anchor, ip - anchor,
+                                    ip - ref, mlen)) )
+                return 0;
+            ip += mlen;
+            anchor = ip;
+            misses = 0;
+        }
+        else
+        {
+/* Incompressible data: skip ahead faster the longer there is no match */
+            step = 1 + (misses++ >> LZ_SKIP_TRIGGER);
+            if((size_t)(end - ip) < step)
+                break;
+            ip += step;
+        }
+    }
+
+/* Last literals */
+    if(anchor < end || op == (byte *)dst)
+        if( !(op = LZ_write_seq(op, oend, anchor, end - anchor, 0, 0)) )
+            return 0;
+    return op - (byte *)dst;
+}
+
+size_t LZ_decompress(const void *src, size_t n, void *dst, size_t cap)
+{
+    const byte *ip = src, *iend = ip + n, *ref;
+    byte *out = dst, *op = out, *oend = out + cap;
+    size_t len, offset, i;
+    byte token, b;
+
+    if(!src || !dst)
+        return 0;
+
+    while(ip < iend)
+    {
+        token = *ip++;
+/* Literals */
+        len = token >> 4;
+        if(len == 15)
+            do
+            {
+                if(ip >= iend)
+                    return 0;
+                len += (b = *ip++);
+            } while(b == 255);
+        if(len > (size_t)(iend - ip) || len > (size_t)(oend - op))
+            return 0;
+        memcpy(op, ip, len);
+        ip += len;
+        op += len;
+        if(ip == iend)
+            break; // last sequence
+
+/* Match */
+        if(iend - ip < 2)
+            return 0;
+        offset = ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if(!offset || offset > (size_t)(op - out))
+            return 0;
+        len = token & 15;
+        if(len == 15)
+            do
+            {
+                if(ip >= iend)
+                    return 0;
+                len += (b = *ip++);
+            } while(b == 255);
+        len += LZ_MIN_MATCH;
+        if(len > (size_t)(oend - op))
+            return 0;
+        ref = op - offset;
+/* Overlapping matches repeat the last *offset* bytes: copy forward */
+        if(offset >= len)
+            memcpy(op, ref, len);
+        else
+            for(i = 0; i < len; i++)
+                op[i] = ref[i];
+        op += len;
+    }
+    return op - out;
+}
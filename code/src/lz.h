@@ -0,0 +1,50 @@
+/**
+ * @file lz.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Interface to lz module
+ *
+ * *lz* is a fast LZ77 block codec in the style of LZ4: the compressed block
+ * is a sequence of literal runs, each followed by a back-reference (offset
+ * up to 64 KiB, length of at least 4 bytes) to data already decoded.
+ * Blocks are independent: each one is decoded on its own.
+ * The decoder checks every length and offset, so corrupted input is
+ * rejected instead of read or written out of bounds.
+ */
+
+#ifndef LZ_H
+#define LZ_H
+
+#include <stdlib.h>
+
+/**
+ * @brief Gets the worst-case compressed size of a block
+ * @param n: length of the uncompressed block
+ * @return max. length of the compressed block
+ */
+size_t LZ_bound(size_t n);
+
+/**
+ * @brief Compresses a block
+ * @param src: data to compress
+ * @param n: length of data
+ * @param dst: destination of the compressed block
+ * @param cap: size of the destination
+ * @return length of the compressed block; 0 if it does not fit in *cap*
+ * (e.g., to store the data uncompressed when it does not shrink)
+ */
+size_t LZ_compress(const void *src, size_t n, void *dst, size_t cap);
+
+/**
+ * @brief Decompresses a block
+ * @param src: compressed block
+ * @param n: length of the compressed block
+ * @param dst: destination of the data
+ * @param cap: size of the destination
+ * @return length of the data; 0 if the block is invalid or the data does
+ * not fit in *cap*
+ */
+size_t LZ_decompress(const void *src, size_t n, void *dst, size_t cap);
+
+#endif // LZ_H
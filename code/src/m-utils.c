@@ -134,6 +134,16 @@ void print_header(const char *header)
     putchar('\n');
 }
 
+char * str_dup(const char *str)
+{
+    if(!str)
+        return NULL;
+
+    char *dup = malloc(strlen(str) + 1);
+    assert(dup);
+    return strcpy(dup, str);
+}
+
 //void purge_input(void)
 //{
 //  int ch;
@@ -153,4 +153,11 @@ void print_msg_wait(const char *msg, int secs);
  */
 void print_header(const char *header);
 
+/**
+ * @brief Duplicates a string
+ * @param str: string to duplicate or NULL
+ * @return newly allocated copy of the string; NULL if str is NULL
+ */
+char * str_dup(const char *str);
+
 #endif
@@ -0,0 +1,279 @@
+/**
+ * @file page.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief page's module implementation
+ */
+
+#include "page.h"
+#include "crc32c.h"
+#include <stdint.h>
+#include <string.h> // memcpy, memmove, memset
+
+/* Header fields: offsets */
+#define PAGE_CRC 0 /**< CRC32C of the rest of the page (32-bit) */
+#define PAGE_NR_SLOTS 4 /**< Nr. of slots */
+#define PAGE_START 6 /**< Start of the records, i.e., end of the free space */
+#define PAGE_FRAG 8 /**< Nr. of bytes freed among the records */
+
+#define PAGE_LEN_MASK 0x3fff /**< Length bits of a slot's length */
+
+typedef unsigned char byte; /**< atomic unit of data */
+
+/**
+ * @brief Loads a 16-bit value stored in little-endian order
+ * @param p: source (2 bytes)
+ * @return value
+ */
+static unsigned Page_get16(const byte *p)
+{
+    return p[0] | (unsigned)p[1] << 8;
+}
+
+/**
+ * @brief Stores a 16-bit value in little-endian order
+ * @param p: destination (2 bytes)
+ * @param val: value to store
+ */
+static void Page_put16(byte *p, unsigned val)
+{
+    p[0] = val;
+    p[1] = val >> 8;
+}
+
+/**
+ * @brief Gets the space taken by a record
+ * @param len: length of the record
+ * @return space taken
+ */
+static size_t Page_alloc(size_t len)
+{
+    return (len < PAGE_REC_MIN ? PAGE_REC_MIN : len);
+}
+
+/**
+ * @brief Gets a slot
+ * @param page: page
+ * @param slot: slot number
+ * @return slot: offset and length of its record
+ */
+static byte * Page_slot(const byte *page, unsigned slot)
+{
+    return (byte *)page + PAGE_HDR_SZ + slot * PAGE_SLOT_SZ;
+}
+
+/**
+ * @brief Gets the size of the free space (between slots and records)
+ * @param page: page
+ * @return nr. of bytes
+ */
+static size_t Page_contiguous(const byte *page)
+{
+    return Page_get16(page + PAGE_START) - 
+           (PAGE_HDR_SZ + Page_get16(page + PAGE_NR_SLOTS) * PAGE_SLOT_SZ);
+}
+
+/**
+ * @brief Moves the records to the end of the page, so the freed space 
+ * joins the free space
+ * @param page: page
+ * @param sz: size of the page
+ */
+static void Page_compact(byte *page, size_t sz)
+{
+    unsigned slot, nr_slots = Page_get16(page + PAGE_NR_SLOTS);
+    byte *tmp = malloc(sz), *s;
+    size_t start = sz, len;
+
+    if(!tmp)
+        return; // it stays fragmented
+    memcpy(tmp, page, sz);
+    for(slot = 0; slot < nr_slots; slot++)
+    {
+        s = Page_slot(page, slot);
+        if( !Page_get16(s) )
+            continue; // free
+        len = Page_alloc(Page_get16(s + 2) & PAGE_LEN_MASK);
+        start -= len;
+        memcpy(page + start, tmp + Page_get16(s), len);
+        Page_put16(s, start);
+    }
+    free(tmp);
+    Page_put16(page + PAGE_START, start);
+    Page_put16(page + PAGE_FRAG, 0);
+}
+
+/**
+ * @brief Takes space for a record from the free space
+ * @param page: page
+ * @param sz: size of the page
+ * @param len: space required
+ * @param new_slot: true, if a new slot is required as well
+ * @return offset of the space; 0 if there is not enough
+ */
+static size_t Page_reserve(byte *page, size_t sz, size_t len, bool new_slot)
+{
+    size_t need = len + (new_slot ? PAGE_SLOT_SZ : 0), start;
+
+    if(Page_contiguous(page) < need)
+    {
+        if(Page_contiguous(page) + Page_get16(page + PAGE_FRAG) < need)
+            return 0;
+        Page_compact(page, sz);
+        if(Page_contiguous(page) < need)
+            return 0;
+    }
+    start = Page_get16(page + PAGE_START) - len;
+    Page_put16(page + PAGE_START, start);
+    return start;
+}
+
+void Page_init(void *page, size_t sz)
+{
+    memset(page, 0, sz);
+    Page_put16((byte *)page + PAGE_START, sz);
+}
+
+void Page_seal(void *page, size_t sz)
+{
+    byte *p = page;
+    uint32_t crc = crc32c(0, p + 4, sz - 4);
+
+    p[0] = crc; p[1] = crc >> 8; p[2] = crc >> 16; p[3] = crc >> 24;
+}
+
+bool Page_check(const void *page, size_t sz)
+{
+    const byte *p = page, *s;
+    unsigned slot, nr_slots = Page_get16(p + PAGE_NR_SLOTS);
+    size_t start = Page_get16(p + PAGE_START), off;
+    uint32_t crc = (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                   (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+
+    if( crc != crc32c(0, p + 4, sz - 4) || start > sz ||
+        PAGE_HDR_SZ + nr_slots * PAGE_SLOT_SZ > start )
+        return false;
+/* Every record within the records' area */
+    for(slot = 0; slot < nr_slots; slot++)
+    {
+        s = Page_slot(p, slot);
+        if( (off = Page_get16(s)) && (off < start || off + 
+            Page_alloc(Page_get16(s + 2) & PAGE_LEN_MASK) > sz) )
+            return false;
+    }
+    return true;
+}
+
+unsigned Page_nr_slots(const void *page)
+{
+    return Page_get16((const byte *)page + PAGE_NR_SLOTS);
+}
+
+size_t Page_free(const void *page)
+{
+    const byte *p = page;
+    unsigned slot, nr_slots = Page_get16(p + PAGE_NR_SLOTS);
+    size_t avail = Page_contiguous(p) + Page_get16(p + PAGE_FRAG);
+
+/* A new slot is taken, unless there is a free one */
+    for(slot = 0; slot < nr_slots; slot++)
+        if( !Page_get16(Page_slot(p, slot)) )
+            break;
+    if(slot == nr_slots)
+        avail = (avail > PAGE_SLOT_SZ ? avail - PAGE_SLOT_SZ : 0);
+    if(avail > PAGE_LEN_MASK)
+        avail = PAGE_LEN_MASK;
+    return (avail < PAGE_REC_MIN ? 0 : avail);
+}
+
+unsigned Page_insert(void *page, size_t sz, const void *rec, size_t len,
+                     unsigned flags)
+{
+    byte *p = page;
+    unsigned slot, nr_slots = Page_get16(p + PAGE_NR_SLOTS);
+    size_t off;
+
+    if(len > PAGE_LEN_MASK)
+        return PAGE_NO_SLOT;
+    for(slot = 0; slot < nr_slots; slot++)
+        if( !Page_get16(Page_slot(p, slot)) )
+            break; // a free slot
+    if( !(off = Page_reserve(p, sz, Page_alloc(len), slot == nr_slots)) )
+        return PAGE_NO_SLOT;
+    if(slot == nr_slots)
+        Page_put16(p + PAGE_NR_SLOTS, nr_slots + 1);
+
+    memcpy(p + off, rec, len);
+    Page_put16(Page_slot(p, slot), off);
+    Page_put16(Page_slot(p, slot) + 2, len | (flags & PAGE_FLAGS));
+    return slot;
+}
+
+const void * Page_get(const void *page, unsigned slot, size_t *len,
+                      unsigned *flags)
+{
+    const byte *s = Page_slot(page, slot);
+    unsigned off;
+
+    if( slot >= Page_nr_slots(page) || !(off = Page_get16(s)) )
+        return NULL;
+    *len = Page_get16(s + 2) & PAGE_LEN_MASK;
+    if(flags)
+        *flags = Page_get16(s + 2) & PAGE_FLAGS;
+    return (const byte *)page + off;
+}
+
+bool Page_update(void *page, size_t sz, unsigned slot, const void *rec,
+                 size_t len, unsigned flags)
+{
+    byte *p = page, *s = Page_slot(p, slot);
+    size_t off, old, frag;
+
+    if( len > PAGE_LEN_MASK || slot >= Page_nr_slots(p) || 
+        !(off = Page_get16(s)) )
+        return false;
+    old = Page_alloc(Page_get16(s + 2) & PAGE_LEN_MASK);
+    frag = Page_get16(p + PAGE_FRAG);
+
+/* Not larger: in place */
+    if(Page_alloc(len) <= old)
+        Page_put16(p + PAGE_FRAG, frag + old - Page_alloc(len));
+/* Larger: in the free space; the old record is freed */
+    else if( Page_contiguous(p) >= Page_alloc(len) )
+    {
+        off = Page_reserve(p, sz, Page_alloc(len), false);
+        Page_put16(p + PAGE_FRAG, frag + old);
+    }
+    else if( Page_contiguous(p) + frag + old >= Page_alloc(len) )
+    {
+        Page_put16(s, 0); // freed, so compacting drops it
+        Page_compact(p, sz);
+        off = Page_reserve(p, sz, Page_alloc(len), false);
+    }
+    else
+        return false;
+
+    memmove(p + off, rec, len);
+    Page_put16(s, off);
+    Page_put16(s + 2, len | (flags & PAGE_FLAGS));
+    return true;
+}
+
+bool Page_delete(void *page, unsigned slot)
+{
+    byte *p = page, *s = Page_slot(p, slot);
+    unsigned nr_slots = Page_nr_slots(p);
+
+    if( slot >= nr_slots || !Page_get16(s) )
+        return false;
+    Page_put16(p + PAGE_FRAG, Page_get16(p + PAGE_FRAG) + 
+               Page_alloc(Page_get16(s + 2) & PAGE_LEN_MASK));
+    Page_put16(s, 0);
+    Page_put16(s + 2, 0);
+/* Free slots at the end are given back to the free space */
+    while( nr_slots && !Page_get16(Page_slot(p, nr_slots - 1)) )
+        nr_slots--;
+    Page_put16(p + PAGE_NR_SLOTS, nr_slots);
+    return true;
+}
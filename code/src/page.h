@@ -0,0 +1,127 @@
+/**
+ * @file page.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Interface to page module
+ *
+ * *page* handles *slotted pages*: fixed-size blocks holding variable-length
+ * records, addressed by their slot number, which never changes while the
+ * record lives (records move inside the page, slots do not).
+ *
+ * |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+ * | header | slot 0 | slot 1 | ... -> free space <- ... | rec 1 | rec 0 |
+ * |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+ *
+ * header: CRC32C of the rest of the page, nr. of slots, start of the
+ * records and nr. of bytes freed among them (16-bit each, little-endian);
+ * slot: offset and length of its record (16-bit each); offset 0 is a free
+ * slot. The high bits of the length are the record's flags (PAGE_FLAG_*).
+ * Freed space is reclaimed by compacting the page when a record does not
+ * fit otherwise. Records take at least PAGE_REC_MIN bytes, so any of them
+ * can be replaced in place by one that small (e.g., a forward reference).
+ * Page sizes go up to 16 KiB.
+ */
+
+#ifndef PAGE_H
+#define PAGE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define PAGE_HDR_SZ 10 /**< Size of the header of a page */
+#define PAGE_SLOT_SZ 4 /**< Size of a slot */
+#define PAGE_REC_MIN 4 /**< Min. space taken by a record */
+#define PAGE_NO_SLOT 0xffff /**< Not a slot (e.g., the record does not fit) */
+
+#define PAGE_FLAG_FORWARD 0x8000 /**< Record flag: moved; holds its new id */
+#define PAGE_FLAG_MOVED 0x4000 /**< Record flag: moved in from another page */
+#define PAGE_FLAGS (PAGE_FLAG_FORWARD | PAGE_FLAG_MOVED) /**< Every flag */
+
+/**
+ * @brief Initializes an empty page
+ * @param page: page
+ * @param sz: size of the page
+ */
+void Page_init(void *page, size_t sz);
+
+/**
+ * @brief Stamps the checksum of a page (before it is written)
+ * @param page: page
+ * @param sz: size of the page
+ */
+void Page_seal(void *page, size_t sz);
+
+/**
+ * @brief Checks a page (after it is read)
+ * @param page: page
+ * @param sz: size of the page
+ * @return true, if its checksum and layout are valid; false, otherwise
+ * (e.g., a torn page)
+ */
+bool Page_check(const void *page, size_t sz);
+
+/**
+ * @brief Gets the nr. of slots of a page (free or not)
+ * @param page: page
+ * @return nr. of slots
+ */
+unsigned Page_nr_slots(const void *page);
+
+/**
+ * @brief Gets the largest record that can be inserted in a page
+ * @param page: page
+ * @return max. length of a new record (counting a new slot for it)
+ */
+size_t Page_free(const void *page);
+
+/**
+ * @brief Inserts a record in a page
+ * @param page: page
+ * @param sz: size of the page
+ * @param rec: record
+ * @param len: length of the record
+ * @param flags: flags of the record (PAGE_FLAG_*)
+ * @return slot of the record; PAGE_NO_SLOT if it does not fit
+ *
+ * Free slots are reused first.
+ */
+unsigned Page_insert(void *page, size_t sz, const void *rec, size_t len,
+                     unsigned flags);
+
+/**
+ * @brief Gets a record of a page
+ * @param page: page
+ * @param slot: slot of the record
+ * @param len: filled with the length of the record
+ * @param flags: filled with the flags of the record; may be NULL
+ * @return record, in the page; NULL if the slot is free or invalid
+ */
+const void * Page_get(const void *page, unsigned slot, size_t *len,
+                      unsigned *flags);
+
+/**
+ * @brief Replaces a record of a page, keeping its slot
+ * @param page: page
+ * @param sz: size of the page
+ * @param slot: slot of the record
+ * @param rec: new record
+ * @param len: length of the new record
+ * @param flags: flags of the new record (PAGE_FLAG_*)
+ * @return true, if replaced; false, if it does not fit (the page is intact)
+ * or the slot is free
+ *
+ * In place, if it is not larger; otherwise, in the free space of the page.
+ */
+bool Page_update(void *page, size_t sz, unsigned slot, const void *rec,
+                 size_t len, unsigned flags);
+
+/**
+ * @brief Removes a record of a page, freeing its slot
+ * @param page: page
+ * @param slot: slot of the record
+ * @return true, if removed; false, if the slot is free or invalid
+ */
+bool Page_delete(void *page, unsigned slot);
+
+#endif // PAGE_H
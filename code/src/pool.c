@@ -0,0 +1,159 @@
+/**
+ * @file pool.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Pool's module implementation
+ */
+
+#include "pool.h"
+#include <stdlib.h> // malloc
+#include <assert.h> // assert
+#include <stddef.h> // max_align_t
+
+#define POOL_CHUNK_MIN 16 /**< Nr. of objects in the first chunk */
+#define POOL_CHUNK_MAX 4096 /**< Max. nr. of objects in a chunk */
+
+/* Chunk
+|||||||||||||||||||||||||||||||||||||
+| next | obj | obj | obj | ... | obj |  <- objects handed out in order (bump)
+|||||||||||||||||||||||||||||||||||||
+free -> obj -> obj -> NULL               <- freed objects (recycled first)
+*/
+
+/**
+ * @brief Chunk header: objects follow it in the same allocation
+ */
+struct Chunk_T{
+    struct Chunk_T *next; /**< next chunk (older) */
+    max_align_t align; /**< keeps the objects that follow aligned */
+};
+
+/**
+ * @brief Free object: its first bytes link to the next free object
+ */
+struct Free_T{
+    struct Free_T *next; /**< next free object */
+};
+
+/**
+ * @brief Pool's structure: contains the relevant data members
+ */
+struct Pool_T{
+    size_t obj_sz; /**< size of each object (aligned) */
+    struct Chunk_T *chunks; /**< list of chunks (newest first) */
+    unsigned char *bump; /**< next never-used object in the newest chunk */
+    unsigned char *end; /**< end of the newest chunk */
+    size_t chunk_objs; /**< nr. of objects of the next chunk */
+    struct Free_T *free; /**< list of freed objects */
+    Pool_Stats_T stats; /**< allocation statistics */
+};
+
+/**
+ * @brief Allocates memory for an Pool's instance
+ * @return initialized memory for Pool
+ *
+ * It is checked by assert to determine if memory was allocated.
+ * If assertion is valid, returns a valid memory address
+ */
+static Pool_T Pool_new()
+{
+    Pool_T pool = malloc(sizeof(*pool));
+    assert(pool);
+    return pool;
+}
+
+/**
+ * @brief Requests a new chunk to the system allocator
+ * @param pool: a valid pool with no free or never-used objects left
+ *
+ * Each chunk doubles the size of the previous one, up to POOL_CHUNK_MAX
+ * objects, so small pools stay small and large pools make few requests.
+ */
+static void Pool_grow(Pool_T pool)
+{
+    struct Chunk_T *chunk = malloc(sizeof(*chunk) +
+                                   pool->chunk_objs * pool->obj_sz);
+    assert(chunk);
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    pool->bump = (unsigned char *)(chunk + 1);
+    pool->end = pool->bump + pool->chunk_objs * pool->obj_sz;
+
+    pool->stats.chunks++;
+    pool->stats.capacity += pool->chunk_objs;
+    if(pool->chunk_objs < POOL_CHUNK_MAX)
+        pool->chunk_objs *= 2;
+}
+
+Pool_T Pool_ctor(size_t obj_sz)
+{
+    Pool_T pool = Pool_new();
+    size_t align = sizeof(max_align_t);
+
+/* Objects must fit a free link and keep the maximum alignment */
+    if(obj_sz < sizeof(struct Free_T))
+        obj_sz = sizeof(struct Free_T);
+    pool->obj_sz = (obj_sz + align - 1) / align * align;
+    pool->chunks = NULL;
+    pool->bump = pool->end = NULL;
+    pool->chunk_objs = POOL_CHUNK_MIN;
+    pool->free = NULL;
+    pool->stats = (Pool_Stats_T){0};
+    return pool;
+}
+
+void Pool_dtor(Pool_T pool)
+{
+    struct Chunk_T *chunk, *next;
+
+    if(!pool)
+        return;
+    for(chunk = pool->chunks; chunk; chunk = next)
+    {
+        next = chunk->next;
+        free(chunk);
+    }
+    free(pool);
+}
+
+void * Pool_alloc(Pool_T pool)
+{
+    void *obj;
+
+    pool->stats.allocs++;
+    pool->stats.in_use++;
+/* Recycle freed objects first: they are likely still in cache */
+    if(pool->free)
+    {
+        obj = pool->free;
+        pool->free = pool->free->next;
+        pool->stats.recycled++;
+        return obj;
+    }
+/* Then hand out never-used objects from the newest chunk */
+    if(pool->bump == pool->end)
+        Pool_grow(pool);
+    obj = pool->bump;
+    pool->bump += pool->obj_sz;
+    return obj;
+}
+
+void Pool_free(Pool_T pool, void *obj)
+{
+    struct Free_T *node = obj;
+
+    if(!obj)
+        return;
+    node->next = pool->free;
+    pool->free = node;
+    pool->stats.frees++;
+    pool->stats.in_use--;
+}
+
+void Pool_get_stats(const Pool_T pool, Pool_Stats_T *stats)
+{
+    if(!pool || !stats)
+        return;
+    *stats = pool->stats;
+}
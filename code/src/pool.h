@@ -0,0 +1,76 @@
+/**
+ * @file pool.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Interface to pool module
+ *
+ * *pool* is a slab allocator for fixed-size objects: objects are handed out
+ * from contiguous chunks and freed objects are recycled through a free list,
+ * so the system allocator is only called once per chunk.
+ * Chunks grow geometrically and are only released when the pool is destroyed.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdlib.h>
+
+/**
+ * @brief opaque pointer to struct Pool_T.
+ * It hides the implementation details (allows modularity)
+ */
+typedef struct Pool_T *Pool_T;
+
+/**
+ * @brief Pool's allocation statistics
+ *
+ * The hit rate, i.e., allocations served without calling the system
+ * allocator, is (allocs - chunks) / allocs.
+ */
+typedef struct Pool_Stats_T{
+    unsigned long allocs; /**< nr. of objects allocated */
+    unsigned long frees; /**< nr. of objects freed */
+    unsigned long recycled; /**< nr. of allocations served by freed objects */
+    unsigned long chunks; /**< nr. of chunks requested to the system */
+    size_t in_use; /**< nr. of objects currently allocated */
+    size_t capacity; /**< nr. of objects that fit in all chunks */
+} Pool_Stats_T;
+
+/**
+ * @brief Constructs a pool
+ * @param obj_sz: size of each object
+ * @return a constructed pool; no memory is reserved until the first alloc
+ */
+Pool_T Pool_ctor(size_t obj_sz);
+
+/**
+ * @brief Destructs a pool and every chunk it owns
+ * @param pool: a valid pool
+ *
+ * Every object allocated from the pool becomes invalid.
+ */
+void Pool_dtor(Pool_T pool);
+
+/**
+ * @brief Allocates an object from the pool
+ * @param pool: a valid pool
+ * @return uninitialized memory for an object
+ */
+void * Pool_alloc(Pool_T pool);
+
+/**
+ * @brief Returns an object to the pool for recycling
+ * @param pool: the pool the object was allocated from
+ * @param obj: a valid object or NULL
+ */
+void Pool_free(Pool_T pool, void *obj);
+
+/**
+ * @brief Gets the pool's allocation statistics
+ * @param pool: a valid pool
+ * @param stats: statistics to be filled in
+ */
+void Pool_get_stats(const Pool_T pool, Pool_Stats_T *stats);
+
+#endif // POOL_H
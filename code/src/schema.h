@@ -0,0 +1,134 @@
+/**
+ * @file schema.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Generator of serialization code from a schema (X-macros)
+ *
+ * A module describes the serialized fields of its struct, in order, as an
+ * X-macro list:
+ *
+ *     #define PACK_SCHEMA(X) \
+ *         X(STR, nome)       \
+ *         X(INT, duracao)    \
+ *         X(REAL, custo)
+ *
+ * and SCHEMA_DEFINE(pack, Pack_T, PACK_SCHEMA) generates, in that module:
+ * - static size_t pack_schema_size(const Pack_T obj): exact encoded size;
+ * - static void pack_schema_encode(const Pack_T obj, Fifo_T fifo): appends
+ * the fields, after reserving their exact size once;
+ * - static bool pack_schema_decode(Pack_T obj, Fifo_T fifo): pops the fields
+ * as per the FIFO's version; false if a field is missing or invalid;
+ * - void pack_print_fields(const Pack_T obj): prints every field, one per
+ * line (public: to be declared in the module's header).
+ *
+ * Field kinds:
+ * - STR: string (char *), length-prefixed; decoded strings are borrowed from
+ * the FIFO (@see Fifo_view_str);
+ * - INT: signed integer, zigzag varint;
+ * - UINT: unsigned integer or enum, varint;
+ * - REAL: float or double, raw;
+ * - CHAR: char, raw.
+ *
+ * In the legacy format (FIFO_VERSION_LEGACY), every field but strings is
+ * raw with its native width.
+ * Changing a schema changes the format: bump FIFO_VERSION and keep the old
+ * layout decodable.
+ * @see fifo.h
+ */
+
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "fifo.h"
+
+/* Size of a field */
+#define SCHEMA_SIZE_STR(v) Fifo_str_size(v)
+#define SCHEMA_SIZE_INT(v) Fifo_svar_size(v)
+#define SCHEMA_SIZE_UINT(v) Fifo_uvar_size(v)
+#define SCHEMA_SIZE_REAL(v) sizeof(v)
+#define SCHEMA_SIZE_CHAR(v) sizeof(v)
+#define SCHEMA_SIZE(kind, field) + SCHEMA_SIZE_##kind(obj->field)
+
+/* Encoding of a field */
+#define SCHEMA_ENC_STR(fifo, v) Fifo_push_str(fifo, v)
+#define SCHEMA_ENC_INT(fifo, v) Fifo_push_svar(fifo, v)
+#define SCHEMA_ENC_UINT(fifo, v) Fifo_push_uvar(fifo, v)
+#define SCHEMA_ENC_REAL(fifo, v) Fifo_push(fifo, &(v), sizeof(v))
+#define SCHEMA_ENC_CHAR(fifo, v) Fifo_push(fifo, &(v), sizeof(v))
+#define SCHEMA_ENCODE(kind, field) SCHEMA_ENC_##kind(fifo, obj->field);
+
+/* Decoding of a field: *ok* is cleared on failure; fields are only
+   assigned when decoded */
+#define SCHEMA_DEC_STR(ok, fifo, v) \
+    ok = ( ((v) = (char *)Fifo_view_str(fifo)) != NULL );
+#define SCHEMA_DEC_INT(ok, fifo, v) \
+    { long long val_; if( (ok = Fifo_pop_svar(fifo, &val_)) ) (v) = val_; }
+#define SCHEMA_DEC_UINT(ok, fifo, v) \
+    { unsigned long long val_; \
+      if( (ok = Fifo_pop_uvar(fifo, &val_)) ) (v) = val_; }
+#define SCHEMA_DEC_REAL(ok, fifo, v) ok = Fifo_pop(fifo, &(v), sizeof(v));
+#define SCHEMA_DEC_CHAR(ok, fifo, v) ok = Fifo_pop(fifo, &(v), sizeof(v));
+#define SCHEMA_DECODE(kind, field) \
+    if(ok) { SCHEMA_DEC_##kind(ok, fifo, obj->field) }
+
+/* Decoding of a field in the legacy format: native widths */
+#define SCHEMA_DEC_LEGACY_STR(ok, fifo, v) SCHEMA_DEC_STR(ok, fifo, v)
+#define SCHEMA_DEC_LEGACY_INT(ok, fifo, v) SCHEMA_DEC_REAL(ok, fifo, v)
+#define SCHEMA_DEC_LEGACY_UINT(ok, fifo, v) SCHEMA_DEC_REAL(ok, fifo, v)
+#define SCHEMA_DEC_LEGACY_REAL(ok, fifo, v) SCHEMA_DEC_REAL(ok, fifo, v)
+#define SCHEMA_DEC_LEGACY_CHAR(ok, fifo, v) SCHEMA_DEC_REAL(ok, fifo, v)
+#define SCHEMA_DECODE_LEGACY(kind, field) \
+    if(ok) { SCHEMA_DEC_LEGACY_##kind(ok, fifo, obj->field) }
+
+/* Printing of a field */
+#define SCHEMA_PRT_STR(v) printf("%s", (v) ? (v) : "(null)")
+#define SCHEMA_PRT_INT(v) printf("%lld", (long long)(v))
+#define SCHEMA_PRT_UINT(v) printf("%llu", (unsigned long long)(v))
+#define SCHEMA_PRT_REAL(v) printf("%g", (double)(v))
+#define SCHEMA_PRT_CHAR(v) printf("%c", (v))
+#define SCHEMA_PRINT(kind, field) \
+    printf("%s: ", #field); SCHEMA_PRT_##kind(obj->field); putchar('\n');
+
+/**
+ * @brief Generates the size, encode, decode and print functions of a schema
+ * @param prefix: prefix of the generated functions' names
+ * @param T: type of the object (pointer to the struct)
+ * @param SCHEMA: X-macro list of the fields
+ */
+#define SCHEMA_DEFINE(prefix, T, SCHEMA)                                    \
+static size_t prefix##_schema_size(const T obj)                             \
+{                                                                           \
+    return 0 SCHEMA(SCHEMA_SIZE);                                           \
+}                                                                           \
+                                                                            \
+static void prefix##_schema_encode(const T obj, Fifo_T fifo)                \
+{                                                                           \
+    Fifo_reserve(fifo,                                                      \
+                 Fifo_get_write_idx(fifo) + prefix##_schema_size(obj));     \
+    SCHEMA(SCHEMA_ENCODE)                                                   \
+}                                                                           \
+                                                                            \
+static bool prefix##_schema_decode(T obj, Fifo_T fifo)                      \
+{                                                                           \
+    size_t ok = 1;                                                          \
+                                                                            \
+    if( Fifo_get_version(fifo) == FIFO_VERSION_LEGACY )                     \
+    {                                                                       \
+        SCHEMA(SCHEMA_DECODE_LEGACY)                                        \
+    }                                                                       \
+    else                                                                    \
+    {                                                                       \
+        SCHEMA(SCHEMA_DECODE)                                               \
+    }                                                                       \
+    return (ok != 0);                                                       \
+}                                                                           \
+                                                                            \
+void prefix##_print_fields(const T obj)                                     \
+{                                                                           \
+    SCHEMA(SCHEMA_PRINT)                                                    \
+}
+
+#endif // SCHEMA_H
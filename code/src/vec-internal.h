@@ -0,0 +1,25 @@
+/**
+ * @file vec-internal.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Internal interface of vec module, shared with list module
+ *
+ * Not part of the public interface: only containers implemented on top of
+ * sorted arrays of data pointers (i.e., *vec* and *list*) include it.
+ */
+
+#ifndef VEC_INTERNAL_H
+#define VEC_INTERNAL_H
+
+/**
+ * @brief Stable merge sort of an array of data pointers (bottom-up)
+ * @param elems: array to sort
+ * @param tmp: scratch array with the same size as elems
+ * @param n: nr. of elements
+ * @param cmp: compare function
+ */
+void Vec_sort_elems(void **elems, void **tmp, unsigned n,
+                    int(*cmp)(const void *data1, const void *data2));
+
+#endif // VEC_INTERNAL_H
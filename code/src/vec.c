@@ -0,0 +1,354 @@
+/**
+ * @file vec.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Vec module implementation
+ */
+
+#include "vec.h"
+#include "vec-internal.h"
+#include <stdio.h> // printf
+#include <stdlib.h> // malloc
+#include <string.h> // memmove
+#include <assert.h> // assert
+#include "m-utils.h" // for print_header
+
+#define VEC_INIT_SZ 16 /**< Nr. of slots of the first allocation */
+
+/**
+ * @brief Vec's structure: sorted array of pointers to data
+ */
+struct Vec_T{
+    void **elems; /**< elements, ascending by Data_cmp */
+    unsigned count; /**< nr of elements in the vector */
+    unsigned size; /**< nr of slots allocated in elems */
+    bool dirty; /**< flags that an update was made or is required */
+    /* function pointers for comparing and destructor */
+    void* (*Data_ctor)(void); /**< pointer to Data constructor function */
+    int (*Data_cmp)(const void *data1, const void *data2); /**< pointer to Data compare function */
+    void (*Data_dtor)(void *data); /**< pointer to Data destructor function */
+    void (*Data_print)(const void *data); /**< pointer to data print function */
+};
+
+/**
+ * @brief Allocates memory for an Vec's instance
+ * @return initialized memory for Vec
+ *
+ * It is checked by assert to determine if memory was allocated.
+ * If assertion is valid, returns a valid memory address
+ */
+static Vec_T Vec_new()
+{
+    Vec_T vec = malloc(sizeof(*vec));
+    assert(vec);
+    return vec;
+}
+
+/**
+ * @brief Ensures there are slots for *n* elements
+ * @param self: a valid vector
+ * @param n: nr. of elements required
+ *
+ * The array grows geometrically, so appending is amortized O(1).
+ */
+static void Vec_reserve(Vec_T self, unsigned n)
+{
+    unsigned size = (self->size ? self->size : VEC_INIT_SZ);
+
+    if(n <= self->size)
+        return;
+    while(size < n)
+        size *= 2;
+    self->elems = realloc(self->elems, size * sizeof(*self->elems));
+    assert(self->elems);
+    self->size = size;
+}
+
+/**
+ * @brief Binary search for the position of an element
+ * @param self: a valid vector
+ * @param elem: comparable element
+ * @param upper: false - first position not less than elem;
+ * true - first position greater than elem
+ * @return position, between 0 and count
+ */
+static unsigned Vec_bound(const Vec_T self, const void *elem, bool upper)
+{
+    unsigned lo = 0, hi = self->count, mid;
+    int cmp_val;
+
+    while(lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        cmp_val = self->Data_cmp(elem, self->elems[mid]);
+        if(cmp_val > 0 || (upper && !cmp_val))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void Vec_sort_elems(void **elems, void **tmp, unsigned n,
+                    int(*cmp)(const void *data1, const void *data2))
+{
+    void **src = elems, **dst = tmp, **swap;
+    unsigned width, lo, mid, hi, i, j, k;
+
+    for(width = 1; width < n; width *= 2)
+    {
+        for(lo = 0; lo < n; lo += 2 * width)
+        {
+            mid = (lo + width < n) ? lo + width : n;
+            hi = (lo + 2 * width < n) ? lo + 2 * width : n;
+            /* Merge runs [lo, mid) and [mid, hi); ties taken from the left */
+            for(i = lo, j = mid, k = lo; k < hi; k++)
+                dst[k] = (j >= hi || (i < mid && cmp(src[i], src[j]) <= 0)) ?
+                    src[i++] : src[j++];
+        }
+        swap = src; src = dst; dst = swap;
+    }
+/* Result must end up in elems */
+    if(src != elems)
+        for(i = 0; i < n; i++)
+            elems[i] = src[i];
+}
+
+Vec_T Vec_ctor( void *(*Data_ctor)(void),
+                int (*Data_cmp)(const void *data1, const void *data2),
+                void (*Data_dtor)(void *data),
+                void (*Data_print)(const void *data))
+{
+    Vec_T vec = Vec_new();
+    vec->Data_ctor = Data_ctor;
+    vec->Data_cmp = Data_cmp;
+    vec->Data_dtor = Data_dtor;
+    vec->Data_print = Data_print;
+
+    vec->elems = NULL;
+    vec->count = vec->size = 0;
+    vec->dirty = false;
+    return vec;
+}
+
+void Vec_dtor(Vec_T self)
+{
+    if(!self)
+        return;
+    free(self->elems);
+    free(self);
+}
+
+void * Vec_insert(Vec_T self, const void *elem, const bool allowDups)
+{
+    if(!self || !elem || !self->Data_cmp)
+        return NULL;
+
+    unsigned pos = Vec_bound(self, elem, allowDups);
+
+/* Repeated element */
+    if(!allowDups && pos < self->count &&
+       !self->Data_cmp(elem, self->elems[pos]))
+        return NULL;
+
+/* Shift the tail one slot and fill the gap */
+    Vec_reserve(self, self->count + 1);
+    memmove(&self->elems[pos + 1], &self->elems[pos],
+            (self->count - pos) * sizeof(*self->elems));
+    self->elems[pos] = (void *)elem;
+    self->count++;
+
+    self->dirty = true; // an item was added
+    return (void *)elem;
+}
+
+unsigned Vec_build(Vec_T self, void **elems, unsigned n,
+                   const bool allowDups)
+{
+    if(!self || !elems || !self->Data_cmp)
+        return 0;
+
+    void **rejected;
+    unsigned i, kept = 0, nr_rej = 0;
+    bool sorted = true;
+
+    rejected = malloc((n ? n : 1) * sizeof(*rejected));
+    assert(rejected);
+
+/* Not empty: insert one at a time */
+    if(self->count)
+    {
+        for(i = 0; i < n; i++)
+            if( Vec_insert(self, elems[i], allowDups) )
+                elems[kept++] = elems[i];
+            else
+                rejected[nr_rej++] = elems[i];
+    }
+    else
+    {
+/* Records written in order need no sorting: one linear check */
+        for(i = 1; i < n && sorted; i++)
+            sorted = ( allowDups ?
+                       self->Data_cmp(elems[i - 1], elems[i]) <= 0 :
+                       self->Data_cmp(elems[i - 1], elems[i]) < 0 );
+        if(!sorted)
+            Vec_sort_elems(elems, rejected, n, self->Data_cmp);
+/* Keep the first of each run of duplicates (sort is stable) */
+        for(i = 0; i < n; i++)
+            if( !allowDups && !sorted && kept &&
+                !self->Data_cmp(elems[kept - 1], elems[i]) )
+                rejected[nr_rej++] = elems[i];
+            else
+                elems[kept++] = elems[i];
+/* Copy in one go */
+        Vec_reserve(self, kept);
+        memcpy(self->elems, elems, kept * sizeof(*elems));
+        self->count = kept;
+        if(kept)
+            self->dirty = true; // items were added
+    }
+
+/* Duplicates are handed back at the end of elems */
+    for(i = 0; i < nr_rej; i++)
+        elems[kept + i] = rejected[i];
+    free(rejected);
+    return kept;
+}
+
+void * Vec_search(const Vec_T self, const void *elem,
+                  int(*cmp)(const void *data1, const void *data2))
+{
+    if(!self || !elem)
+        return NULL;
+
+    unsigned i;
+
+/* Search by the default comparator: binary search */
+    if(!cmp || cmp == self->Data_cmp)
+    {
+        i = Vec_bound(self, elem, false);
+        if(i < self->count && !self->Data_cmp(elem, self->elems[i]))
+            return self->elems[i];
+        return NULL;
+    }
+
+/* Otherwise, linear search */
+    for(i = 0; i < self->count; i++)
+        if( !cmp(elem, self->elems[i]) )
+            return self->elems[i];
+    return NULL;
+}
+
+bool Vec_remove(Vec_T self, const void *elem)
+{
+    if(!self || !elem)
+        return false;
+
+    unsigned pos;
+
+/* Locate by key; the data must match by pointer */
+    for(pos = Vec_bound(self, elem, false); pos < self->count; pos++)
+        if(self->elems[pos] == elem ||
+           self->Data_cmp(elem, self->elems[pos]))
+            break;
+/* Fallback: linear scan by pointer (e.g., key was edited in place) */
+    if(pos == self->count || self->elems[pos] != elem)
+        for(pos = 0; pos < self->count; pos++)
+            if(self->elems[pos] == elem)
+                break;
+    if(pos == self->count)
+        return false;
+
+/* Close the gap */
+    memmove(&self->elems[pos], &self->elems[pos + 1],
+            (self->count - pos - 1) * sizeof(*self->elems));
+    self->count--;
+
+    self->dirty = true; // an item was removed
+    return true;
+}
+
+void Vec_sort(Vec_T self)
+{
+    if(!self || self->count < 2)
+        return;
+
+    void **tmp = malloc(self->count * sizeof(*tmp));
+    assert(tmp);
+    Vec_sort_elems(self->elems, tmp, self->count, self->Data_cmp);
+    free(tmp);
+}
+
+unsigned Vec_count(const Vec_T self)
+{
+    return (self ? self->count : 0);
+}
+
+void * Vec_get(const Vec_T self, unsigned idx)
+{
+    if(!self || idx >= self->count)
+        return NULL;
+    return self->elems[idx];
+}
+
+void Vec_foreach(const Vec_T self, void (*fcn)(void *data, void *ctx),
+                 void *ctx)
+{
+    if(!self || !fcn)
+        return;
+
+    unsigned i;
+
+    for(i = 0; i < self->count; i++)
+        fcn(self->elems[i], ctx);
+}
+
+void Vec_print_all(const Vec_T self,
+                   void(*print)(const void *data), bool numbered,
+                   const char *header)
+{
+    if(!self)
+        return;
+
+    if(!print)
+        print = self->Data_print;
+
+    unsigned i;
+
+/* Print size */
+    printf("\n\t\tTotal de elementos: %u\n\n", self->count);
+/* Print header */
+    if(header)
+        print_header(header);
+    for(i = 0; i < self->count; i++)
+    {
+/* Print numbering */
+        if(numbered)
+            printf("%.2d, ", i + 1);
+/* Print data */
+        print(self->elems[i]);
+    }
+}
+
+void Vec_print_elem(const Vec_T self, const void *elem,
+                    void(*print)(const void *data) )
+{
+    if(!self || !elem)
+        return;
+/* Define the printing function */
+    if(!print)
+        print = self->Data_print;
+/* Print the element */
+    print( elem );
+}
+
+bool Vec_isDirty(const Vec_T self)
+{
+    return self->dirty;
+}
+
+void Vec_set_dirty(Vec_T self, const bool dirty)
+{
+    self->dirty = dirty;
+}
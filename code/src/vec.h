@@ -0,0 +1,167 @@
+/**
+ * @file vec.h
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Interface to vec module
+ *
+ * *vec* is a generic sorted array: an alternative to *list* for collections
+ * that are read far more often than written. Elements are kept contiguous
+ * and in ascending order by the default comparator, so search is a binary
+ * search and traversals do not chase pointers; inserting and removing shift
+ * the elements after the position, O(n).
+ * Like *list*, it does not own the data; it only stores pointers to it, and
+ * it requires client modules to implement the constructor, comparator,
+ * destructor and printer functions.
+ */
+
+#ifndef VEC_H
+#define VEC_H
+
+#include <stdbool.h>
+
+/**
+ * @brief opaque pointer to struct Vec_T.
+ * It hides the implementation details (allows modularity)
+ */
+typedef struct Vec_T *Vec_T;
+
+/**
+ * @brief Constructs a vector
+ * @param Data_ctor: a function pointer for a Data constructor
+ * @param Data_cmp: a function pointer for a Data comparator
+ * @param Data_dtor: a function pointer for a Data destructor
+ * @param Data_print: a function pointer for a Data printer
+ * @return a constructed, empty vector
+ */
+Vec_T Vec_ctor( void *(*Data_ctor)(void),
+                int (*Data_cmp)(const void *data1, const void *data2),
+                void (*Data_dtor)(void *data),
+                void (*Data_print)(const void *data));
+
+/**
+ * @brief Destructs a vector (the data is not destroyed)
+ * @param self: a valid vector
+ */
+void Vec_dtor(Vec_T self);
+
+/**
+ * @brief Inserts an element in ascending order by the default comparator
+ * @param self: a valid vector
+ * @param elem: element to insert
+ * @param allowDups: true - duplicates allowed; false - duplicates disallowed
+ * @return data inserted; NULL if it is a disallowed duplicate
+ */
+void * Vec_insert(Vec_T self, const void *elem, const bool allowDups);
+
+/**
+ * @brief Inserts a batch of elements in ascending order by the default
+ * compare function
+ * @param self: a valid vector
+ * @param elems: array of elements to insert; it is reordered
+ * @param n: nr. of elements
+ * @param allowDups: true, to insert duplicates (after the equal ones, in
+ * the order given); false, otherwise
+ * @return nr. of elements inserted
+ *
+ * Without allowDups, same contract as List_build: duplicates are not
+ * inserted (the first occurrence is kept) and are handed back at the end
+ * of elems. An empty vector is filled by a single sort, O(n log n).
+ * @see list.h
+ */
+unsigned Vec_build(Vec_T self, void **elems, unsigned n,
+                   const bool allowDups);
+
+/**
+ * @brief Search a similar element in the vector
+ * @param self: a valid vector
+ * @param elem: comparable element to perform the search
+ * @param cmp: compare function to be used in the search; if NULL it uses the default compare function
+ * @return data found; NULL otherwise
+ *
+ * Binary search, O(log n), with the default compare function;
+ * linear search with any other.
+ */
+void * Vec_search(const Vec_T self, const void *elem,
+                  int(*cmp)(const void *data1, const void *data2));
+
+/**
+ * @brief Removes element in the vector returned by search
+ * @param self: a valid vector
+ * @param elem: element returned by search
+ * @return true, if removed; false, otherwise
+ */
+bool Vec_remove(Vec_T self, const void *elem);
+
+/**
+ * @brief Sorts the vector by the default comparator
+ * @param self: a valid vector
+ *
+ * It is required when the sorting key of an element is updated in place.
+ * Stable merge sort, O(n log n).
+ */
+void Vec_sort(Vec_T self);
+
+/**
+ * @brief Gets the nr. of elements in the vector
+ * @param self: a valid vector
+ * @return nr. of elements in the vector
+ */
+unsigned Vec_count(const Vec_T self);
+
+/**
+ * @brief Gets an element of the vector by position
+ * @param self: a valid vector
+ * @param idx: position, starting at 0
+ * @return element; NULL if out of range
+ */
+void * Vec_get(const Vec_T self, unsigned idx);
+
+/**
+ * @brief Calls a function for every element in the vector, in order
+ * @param self: a valid vector
+ * @param fcn: function called with each element and *ctx*
+ * @param ctx: user context passed to the function; may be NULL
+ */
+void Vec_foreach(const Vec_T self, void (*fcn)(void *data, void *ctx),
+                 void *ctx);
+
+/**
+ * @brief Prints all elements in the vector
+ * @param self: a valid vector
+ * @param print: pointer to function print; if NULL it uses the default one
+ * @param numbered: true - prints the elements with numbering
+ * @param header: header; used for tabled
+ *
+ * The print functions must be implemented by the client module
+ */
+void Vec_print_all(const Vec_T self,
+                   void(*print)(const void *data), bool numbered,
+                   const char *header);
+
+/**
+ * @brief Prints an element of the vector
+ * @param self: a valid vector
+ * @param elem: element to print
+ * @param print: pointer to function print; if NULL it uses the default one
+ */
+void Vec_print_elem(const Vec_T self, const void *elem,
+                    void(*print)(const void *data) );
+
+/**
+ * @brief Checks if vector is *dirty*, i.e., if it was updated or requires
+ * an update
+ * @param self: a valid vector
+ * @return true, if dirty; false, otherwise
+ */
+bool Vec_isDirty(const Vec_T self);
+
+/**
+ * @brief Sets the *dirty* flag of the vector, signaling
+ * it was updated or requires an update
+ * @param self: a valid vector
+ * @param dirty: dirty flag
+ */
+void Vec_set_dirty(Vec_T self, const bool dirty);
+
+#endif // VEC_H
@@ -0,0 +1,179 @@
+/**
+ * @file page_test.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Tests of the paged Database (@see Database_open_paged)
+ *
+ * Inserts records past the first page, updates them in place, grows one
+ * out of its page (so it is moved and its home refers to it), removes
+ * records and reopens the file, checking every record by its id.
+ */
+
+#include "Database.h"
+#include "fifo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#define TEST_DB "page_test.db" /**< File of the tests */
+#define NR_RECS 200 /**< Records inserted */
+#define REC_SZ 100 /**< Length of a small record */
+#define BIG_SZ 3000 /**< Length of a record grown out of its page */
+
+static unsigned nr_fails = 0; /**< Nr. of failed checks */
+
+/**
+ * @brief Checks a condition, reporting it if it fails
+ */
+#define CHECK(cond) \
+    do { if(!(cond)) { nr_fails++; \
+         printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); } } \
+    while(0)
+
+/**
+ * @brief Fills a record with a pattern of its own
+ * @param rec: record
+ * @param sz: length of the record
+ * @param seed: seed of the pattern
+ */
+static void fill(unsigned char *rec, size_t sz, unsigned seed)
+{
+    size_t i;
+
+    for(i = 0; i < sz; i++)
+        rec[i] = (unsigned char)(seed * 31 + i);
+}
+
+/**
+ * @brief Checks that a record reads back as written
+ * @param db: a paged Database
+ * @param id: id of the record
+ * @param sz: length of the record
+ * @param seed: seed of the pattern written
+ * @return true, if it matches; false, otherwise
+ */
+static bool matches(Database_T db, uint32_t id, size_t sz, unsigned seed)
+{
+    unsigned char rec[BIG_SZ];
+    Fifo_T fifo = Database_read_id(db, id);
+    bool ok;
+
+    fill(rec, sz, seed);
+    ok = fifo && Fifo_get_write_idx(fifo) == sz &&
+         !memcmp(Fifo_get_data(fifo), rec, sz);
+    Fifo_dtor(fifo);
+    return ok;
+}
+
+/**
+ * @brief Counts the records walked by Database_next
+ * @param db: a paged Database
+ * @param id: id to be found in the walk
+ * @param found: filled with the nr. of times *id* was walked
+ * @return nr. of records
+ */
+static unsigned walk(Database_T db, uint32_t id, unsigned *found)
+{
+    uint32_t at = 0;
+    unsigned n = 0;
+    Fifo_T rec;
+
+    *found = 0;
+    while( (rec = Database_next(db, &at)) )
+    {
+        n++;
+        *found += (at == id);
+        Fifo_dtor(rec);
+    }
+    return n;
+}
+
+/**
+ * @brief Gets the nr. of pages of the file
+ * @return nr. of pages, the header's included
+ */
+static long nr_pages(void)
+{
+    struct stat st;
+
+    return stat(TEST_DB, &st) ? -1 : (long)(st.st_size / DB_PAGE_SZ);
+}
+
+int main(void)
+{
+    unsigned char rec[BIG_SZ];
+    uint32_t ids[NR_RECS];
+    unsigned i, found;
+    long pages;
+    Database_T db;
+
+    remove(TEST_DB);
+    db = Database_ctor(TEST_DB);
+    CHECK( Database_open_paged(db) );
+
+/* Insert: past the first page */
+    for(i = 0; i < NR_RECS; i++)
+    {
+        fill(rec, REC_SZ, i);
+        CHECK( Database_insert(db, rec, REC_SZ, &ids[i]) );
+    }
+    CHECK( nr_pages() > 2 );
+    for(i = 0; i < NR_RECS; i++)
+        CHECK( matches(db, ids[i], REC_SZ, i) );
+    CHECK( walk(db, ids[0], &found) == NR_RECS && found == 1 );
+/* The header page holds no records */
+    CHECK( !Database_read_id(db, 0) && !Database_read_id(db, 1) );
+    CHECK( !Database_insert(db, rec, DB_REC_MAX + 1, &ids[0]) );
+
+/* Update in place: same id, new data */
+    fill(rec, REC_SZ, 1000);
+    CHECK( Database_write_id(db, ids[1], rec, REC_SZ) );
+    CHECK( matches(db, ids[1], REC_SZ, 1000) );
+    CHECK( matches(db, ids[0], REC_SZ, 0) && matches(db, ids[2], REC_SZ, 2) );
+
+/* Grown out of its (full) page: moved, reached through its home */
+    fill(rec, BIG_SZ, 2000);
+    CHECK( Database_write_id(db, ids[3], rec, BIG_SZ) );
+    CHECK( matches(db, ids[3], BIG_SZ, 2000) );
+    CHECK( matches(db, ids[4], REC_SZ, 4) );
+    CHECK( walk(db, ids[3], &found) == NR_RECS && found == 1 );
+/* A moved record is updated where it is, or moved again */
+    fill(rec, BIG_SZ - 1, 3000);
+    CHECK( Database_write_id(db, ids[3], rec, BIG_SZ - 1) );
+    CHECK( matches(db, ids[3], BIG_SZ - 1, 3000) );
+    fill(rec, REC_SZ, 4000);
+    CHECK( Database_write_id(db, ids[3], rec, REC_SZ) );
+    CHECK( matches(db, ids[3], REC_SZ, 4000) );
+    fill(rec, BIG_SZ, 5000);
+    CHECK( Database_write_id(db, ids[5], rec, BIG_SZ) );
+    CHECK( walk(db, ids[5], &found) == NR_RECS && found == 1 );
+
+/* Remove: a moved one (and its copy) and one in place */
+    CHECK( Database_remove(db, ids[5]) && !Database_read_id(db, ids[5]) );
+    CHECK( Database_remove(db, ids[6]) && !Database_read_id(db, ids[6]) );
+    CHECK( !Database_remove(db, ids[6]) );
+    CHECK( walk(db, ids[5], &found) == NR_RECS - 2 && !found );
+    CHECK( Database_close(db) );
+
+/* Reopen: every record is still there, and there is room for more */
+    CHECK( Database_open_paged(db) );
+    CHECK( matches(db, ids[1], REC_SZ, 1000) );
+    CHECK( matches(db, ids[3], REC_SZ, 4000) );
+    for(i = 7; i < NR_RECS; i++)
+        CHECK( matches(db, ids[i], REC_SZ, i) );
+    pages = nr_pages();
+    fill(rec, REC_SZ, 6000);
+    CHECK( Database_insert(db, rec, REC_SZ, &ids[5]) );
+    CHECK( nr_pages() == pages ); // in the room freed
+    CHECK( matches(db, ids[5], REC_SZ, 6000) );
+    CHECK( walk(db, ids[5], &found) == NR_RECS - 1 && found == 1 );
+    Database_close(db);
+    Database_dtor(db);
+    remove(TEST_DB);
+
+    printf("page_test: %s\n", nr_fails ? "FAILED" : "passed");
+    return nr_fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
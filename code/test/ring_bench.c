@@ -0,0 +1,106 @@
+/**
+ * @file ring_bench.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Throughput of the ring mode of the FIFO (@see Fifo_ring_ctor)
+ *
+ * A producer thread streams fixed-size records to a consumer thread
+ * through rings of several sizes; both yield the CPU when the ring is
+ * full or empty. Prints the records and bytes per second of each size.
+ */
+
+#include "fifo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define REC_SZ 64 /**< Length of a record (e.g., a small serialized one) */
+#define NR_RECS 20000000 /**< Records streamed per ring size */
+
+/**
+ * @brief Producer thread: pushes every record, retrying while full
+ * @param ring: a ring
+ * @return NULL
+ */
+static void * producer(void *ring)
+{
+    unsigned char rec[REC_SZ];
+    unsigned i;
+
+    memset(rec, 0, sizeof(rec));
+    for(i = 0; i < NR_RECS; i++)
+    {
+        memcpy(rec, &i, sizeof(i));
+        while( !Fifo_ring_push(ring, rec, REC_SZ) )
+            sched_yield();
+    }
+    return NULL;
+}
+
+/**
+ * @brief Consumer thread: pops every record, retrying while empty
+ * @param ring: a ring
+ * @return nr. of records out of order (none, if the ring works)
+ */
+static void * consumer(void *ring)
+{
+    unsigned char rec[REC_SZ];
+    size_t bad = 0;
+    unsigned i, seq;
+
+    for(i = 0; i < NR_RECS; i++)
+    {
+        while( !Fifo_ring_pop(ring, rec, REC_SZ) )
+            sched_yield();
+        memcpy(&seq, rec, sizeof(seq));
+        bad += (seq != i);
+    }
+    return (void *)bad;
+}
+
+/**
+ * @brief Gets the time elapsed since an instant
+ * @param start: instant
+ * @return seconds
+ */
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(void)
+{
+    static const size_t sizes[] = { 4 << 10, 64 << 10, 1 << 20 };
+    struct timespec start;
+    pthread_t prod, cons;
+    Fifo_T ring;
+    void *bad;
+    double secs;
+    unsigned i;
+
+    printf("ring_bench: %d records of %d bytes\n", NR_RECS, REC_SZ);
+    for(i = 0; i < sizeof(sizes) / sizeof(*sizes); i++)
+    {
+        ring = Fifo_ring_ctor(sizes[i]);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pthread_create(&cons, NULL, consumer, ring);
+        pthread_create(&prod, NULL, producer, ring);
+        pthread_join(prod, NULL);
+        pthread_join(cons, &bad);
+        secs = elapsed(&start);
+        printf("  ring %5zu KiB: %6.1f Mrec/s, %6.0f MB/s%s\n",
+               sizes[i] >> 10, NR_RECS / secs / 1e6,
+               (double)NR_RECS * REC_SZ / secs / 1e6,
+               bad ? " (OUT OF ORDER)" : "");
+        Fifo_dtor(ring);
+    }
+    return 0;
+}
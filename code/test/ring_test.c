@@ -0,0 +1,153 @@
+/**
+ * @file ring_test.c
+ * @author Jose Pires
+ * @date 17 Oct 2026
+ *
+ * @brief Tests of the ring mode of the FIFO (@see Fifo_ring_ctor)
+ *
+ * Records wrap around the end of a small ring, first in a single thread
+ * (with the ring full and empty), then between a producer and a consumer
+ * thread, which checks that every record arrives whole and in order.
+ */
+
+#include "fifo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define RING_SZ 128 /**< Size of the ring */
+#define REC_MAX 60 /**< Max. length of a record */
+#define NR_RECS 1000000 /**< Records streamed between the threads */
+
+static unsigned nr_fails = 0; /**< Nr. of failed checks */
+
+/**
+ * @brief Checks a condition, reporting it if it fails
+ */
+#define CHECK(cond) \
+    do { if(!(cond)) { nr_fails++; \
+         printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); } } \
+    while(0)
+
+/**
+ * @brief Gets the length of a record
+ * @param i: nr. of the record
+ * @return length, between 1 and REC_MAX (so records straddle the end of
+ * the ring at every offset)
+ */
+static size_t rec_len(unsigned i)
+{
+    return 1 + (i * 7) % REC_MAX;
+}
+
+/**
+ * @brief Fills a record with a pattern of its own
+ * @param rec: record
+ * @param i: nr. of the record
+ */
+static void fill(unsigned char *rec, unsigned i)
+{
+    size_t k, len = rec_len(i);
+
+    for(k = 0; k < len; k++)
+        rec[k] = (unsigned char)(i + k * 13);
+}
+
+/**
+ * @brief Producer thread: pushes every record, retrying while full
+ * @param ring: a ring
+ * @return NULL
+ */
+static void * producer(void *ring)
+{
+    unsigned char rec[REC_MAX];
+    unsigned i;
+
+    for(i = 0; i < NR_RECS; i++)
+    {
+        fill(rec, i);
+        while( !Fifo_ring_push(ring, rec, rec_len(i)) )
+            sched_yield();
+    }
+    return NULL;
+}
+
+/**
+ * @brief Consumer thread: pops every record, retrying while empty
+ * @param ring: a ring
+ * @return nr. of records that did not arrive as pushed
+ */
+static void * consumer(void *ring)
+{
+    unsigned char rec[REC_MAX], exp[REC_MAX];
+    size_t bad = 0;
+    unsigned i;
+
+    for(i = 0; i < NR_RECS; i++)
+    {
+        while( !Fifo_ring_pop(ring, rec, rec_len(i)) )
+            sched_yield();
+        fill(exp, i);
+        bad += ( memcmp(rec, exp, rec_len(i)) != 0 );
+    }
+    return (void *)bad;
+}
+
+int main(void)
+{
+    unsigned char rec[REC_MAX], exp[REC_MAX];
+    Fifo_T ring = Fifo_ring_ctor(RING_SZ - 1);
+    unsigned first = 0, next = 0;
+    size_t used = 0;
+    pthread_t prod, cons;
+    void *bad;
+
+/* Power of two, at least the size asked for */
+    CHECK( Fifo_get_size(ring) == RING_SZ );
+    CHECK( !Fifo_ring_count(ring) );
+    CHECK( !Fifo_ring_pop(ring, rec, 1) );
+
+/* Single thread: fill the ring up, then drain a record and refill, so
+   records wrap around its end */
+    while(next < 10000)
+    {
+        fill(rec, next);
+        if( Fifo_ring_push(ring, rec, rec_len(next)) )
+        {
+            used += rec_len(next++);
+            continue;
+        }
+/* Full: nothing was pushed; more than the room left was asked for */
+        CHECK( Fifo_ring_count(ring) == used );
+        CHECK( used + rec_len(next) > RING_SZ );
+        CHECK( Fifo_ring_pop(ring, rec, rec_len(first)) );
+        fill(exp, first);
+        CHECK( !memcmp(rec, exp, rec_len(first)) );
+        used -= rec_len(first++);
+    }
+/* Drain: every record in order, then empty */
+    for(; first < next; first++)
+    {
+        CHECK( !Fifo_ring_pop(ring, rec, used + 1) ); // more than there is
+        CHECK( Fifo_ring_pop(ring, rec, rec_len(first)) );
+        fill(exp, first);
+        CHECK( !memcmp(rec, exp, rec_len(first)) );
+        used -= rec_len(first);
+    }
+    CHECK( !used && !Fifo_ring_count(ring) );
+    CHECK( !Fifo_ring_push(ring, rec, RING_SZ + 1) ); // rings never grow
+
+/* Two threads: every record arrives whole and in order */
+    pthread_create(&cons, NULL, consumer, ring);
+    pthread_create(&prod, NULL, producer, ring);
+    pthread_join(prod, NULL);
+    pthread_join(cons, &bad);
+    CHECK( !bad );
+    CHECK( !Fifo_ring_count(ring) );
+    Fifo_dtor(ring);
+
+    printf("ring_test: %s\n", nr_fails ? "FAILED" : "passed");
+    return nr_fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}